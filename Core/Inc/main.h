@@ -42,6 +42,63 @@ extern "C" {
 /* Exported constants --------------------------------------------------------*/
 /* USER CODE BEGIN EC */
 
+/**
+ * Тактирование (приложение и загрузчик): единственный параметр - частота ядра
+ * SYSCLK_FREQ (HSE 8 МГц x PLL), остальные частоты и прескелеры вычисляются
+ * при компиляции и проверяются _Static_assert (прескелеры таймеров - в tim.c).
+ */
+#ifndef SYSCLK_FREQ
+#define SYSCLK_FREQ 72000000 ///< Частота ядра (HCLK) в Гц, не больше 72 МГц
+#endif
+
+#define SYSCLK_PLL_MUL (SYSCLK_FREQ / HSE_VALUE) ///< Множитель PLL (2..16)
+#define SYSCLK_RCC_PLL_MUL                                                     \
+  ((SYSCLK_PLL_MUL - 2) << RCC_CFGR_PLLMULL_Pos) ///< RCC_PLL_MULx
+#define SYSCLK_FLASH_LATENCY                                                   \
+  (SYSCLK_FREQ <= 24000000   ? FLASH_LATENCY_0                                 \
+   : SYSCLK_FREQ <= 48000000 ? FLASH_LATENCY_1                                 \
+                             : FLASH_LATENCY_2) ///< Задержка чтения flash
+
+/**
+ * Частоты APB1/APB2 - SYSCLK / SYSCLK_APB_DIV на любом уровне частоты ядра
+ * (clock_governor.c: AHB /1 и APB /4 или AHB /2 и APB /2).
+ */
+#define SYSCLK_APB_DIV 4
+#define PCLK1_FREQ (SYSCLK_FREQ / SYSCLK_APB_DIV) ///< APB1, не больше 36 МГц
+#define PCLK2_FREQ (SYSCLK_FREQ / SYSCLK_APB_DIV) ///< APB2
+#define TIM_APB1_FREQ                                                          \
+  (PCLK1_FREQ * 2) ///< Таймеры APB1 (TIM2-4): x2 при делителе APB1 > 1
+#define TIM_APB2_FREQ                                                          \
+  (PCLK2_FREQ * 2) ///< Таймеры APB2 (TIM1): x2 при делителе APB2 > 1
+
+_Static_assert(SYSCLK_FREQ <= 72000000, "SYSCLK_FREQ: max 72 MHz");
+_Static_assert(SYSCLK_FREQ % HSE_VALUE == 0 && SYSCLK_PLL_MUL >= 2 &&
+                   SYSCLK_PLL_MUL <= 16,
+               "SYSCLK_FREQ: must be HSE_VALUE x 2..16 (PLL)");
+_Static_assert(PCLK1_FREQ <= 36000000, "APB1: max 36 MHz");
+
+/**
+ * Битовая синхронизация CAN (APB1): бит = CAN_TQ_PER_BIT квантов (1 + BS1 +
+ * BS2 2), точка выборки (1 + BS1) / CAN_TQ_PER_BIT. Кол-во квантов выбрано
+ * так, что прескелеры скоростей 125/200/250/500 кбит/с не зависят от частоты:
+ * 16 квантов при 16 МГц, 18 квантов при 18 МГц.
+ */
+#define CAN_TQ_PER_BIT (PCLK1_FREQ / 1000000)
+#define CAN_BS2_TQ 2                                        ///< Квантов BS2
+#define CAN_BS1_TQ (CAN_TQ_PER_BIT - 1 - CAN_BS2_TQ)        ///< Квантов BS1
+#define CAN_TIME_SEG1 ((CAN_BS1_TQ - 1) << CAN_BTR_TS1_Pos) ///< CAN_BS1_xTQ
+#define CAN_TIME_SEG2 ((CAN_BS2_TQ - 1) << CAN_BTR_TS2_Pos) ///< CAN_BS2_xTQ
+#define CAN_PRESCALER(bitrate)                                                 \
+  (PCLK1_FREQ / ((bitrate) * CAN_TQ_PER_BIT)) ///< Прескелер для скорости
+
+_Static_assert(CAN_BS1_TQ >= 1 && CAN_BS1_TQ <= 16,
+               "CAN: APB1 frequency gives no valid BS1 (1..16 quanta)");
+_Static_assert(PCLK1_FREQ % (125000 * CAN_TQ_PER_BIT) == 0 &&
+                   PCLK1_FREQ % (200000 * CAN_TQ_PER_BIT) == 0 &&
+                   PCLK1_FREQ % (250000 * CAN_TQ_PER_BIT) == 0 &&
+                   PCLK1_FREQ % (500000 * CAN_TQ_PER_BIT) == 0,
+               "CAN: bitrate is not an exact division of APB1 frequency");
+
 /* USER CODE END EC */
 
 /* Exported macro ------------------------------------------------------------*/
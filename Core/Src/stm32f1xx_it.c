@@ -22,7 +22,8 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include "isr_budget.h"
+#include "timer_wheel.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -175,11 +176,12 @@ void PendSV_Handler(void) {
  */
 void SysTick_Handler(void) {
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
-
+  timer_wheel_tick();
+  ISR_BUDGET_EXIT(ISR_ID_TICK);
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -195,11 +197,11 @@ void SysTick_Handler(void) {
  */
 void USB_HP_CAN1_TX_IRQHandler(void) {
   /* USER CODE BEGIN USB_HP_CAN1_TX_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END USB_HP_CAN1_TX_IRQn 0 */
   HAL_CAN_IRQHandler(&hcan);
   /* USER CODE BEGIN USB_HP_CAN1_TX_IRQn 1 */
-
+  ISR_BUDGET_EXIT(ISR_ID_CAN_TX);
   /* USER CODE END USB_HP_CAN1_TX_IRQn 1 */
 }
 
@@ -208,11 +210,11 @@ void USB_HP_CAN1_TX_IRQHandler(void) {
  */
 void USB_LP_CAN1_RX0_IRQHandler(void) {
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 0 */
   HAL_CAN_IRQHandler(&hcan);
   /* USER CODE BEGIN USB_LP_CAN1_RX0_IRQn 1 */
-
+  ISR_BUDGET_EXIT(ISR_ID_CAN_RX);
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
@@ -221,11 +223,11 @@ void USB_LP_CAN1_RX0_IRQHandler(void) {
  */
 void CAN1_SCE_IRQHandler(void) {
   /* USER CODE BEGIN CAN1_SCE_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END CAN1_SCE_IRQn 0 */
   HAL_CAN_IRQHandler(&hcan);
   /* USER CODE BEGIN CAN1_SCE_IRQn 1 */
-
+  ISR_BUDGET_EXIT(ISR_ID_CAN_SCE);
   /* USER CODE END CAN1_SCE_IRQn 1 */
 }
 
@@ -234,11 +236,11 @@ void CAN1_SCE_IRQHandler(void) {
  */
 void TIM1_CC_IRQHandler(void) {
   /* USER CODE BEGIN TIM1_CC_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END TIM1_CC_IRQn 0 */
   HAL_TIM_IRQHandler(&htim1);
   /* USER CODE BEGIN TIM1_CC_IRQn 1 */
-
+  ISR_BUDGET_EXIT(ISR_ID_TIM1_CC);
   /* USER CODE END TIM1_CC_IRQn 1 */
 }
 
@@ -247,11 +249,11 @@ void TIM1_CC_IRQHandler(void) {
  */
 void TIM2_IRQHandler(void) {
   /* USER CODE BEGIN TIM2_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END TIM2_IRQn 0 */
   HAL_TIM_IRQHandler(&htim2);
   /* USER CODE BEGIN TIM2_IRQn 1 */
-
+  ISR_BUDGET_EXIT(ISR_ID_SOUND);
   /* USER CODE END TIM2_IRQn 1 */
 }
 
@@ -273,11 +275,11 @@ void TIM3_IRQHandler(void) {
  */
 void TIM4_IRQHandler(void) {
   /* USER CODE BEGIN TIM4_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END TIM4_IRQn 0 */
   HAL_TIM_IRQHandler(&htim4);
   /* USER CODE BEGIN TIM4_IRQn 1 */
-
+  ISR_BUDGET_EXIT(ISR_ID_SCAN);
   /* USER CODE END TIM4_IRQn 1 */
 }
 
@@ -299,7 +301,7 @@ void TIM4_IRQHandler(void) {
  */
 void EXTI15_10_IRQHandler(void) {
   /* USER CODE BEGIN EXTI15_10_IRQn 0 */
-
+  ISR_BUDGET_ENTER();
   /* USER CODE END EXTI15_10_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(BUTTON_1_Pin);
   HAL_GPIO_EXTI_IRQHandler(BUTTON_2_Pin);
@@ -307,6 +309,7 @@ void EXTI15_10_IRQHandler(void) {
 
   HAL_GPIO_EXTI_IRQHandler(DATA_Pin);
 
+  ISR_BUDGET_EXIT(ISR_ID_BUTTONS);
   /* USER CODE END EXTI15_10_IRQn 1 */
 }
 
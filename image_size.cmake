@@ -0,0 +1,9 @@
+# Проверка размера образа после сборки (POST_BUILD):
+# cmake -DIMAGE=<файл .bin> -DLIMIT=<байт> -P image_size.cmake
+file(SIZE ${IMAGE} IMAGE_SIZE)
+math(EXPR IMAGE_FREE "${LIMIT} - ${IMAGE_SIZE}")
+
+if(IMAGE_SIZE GREATER LIMIT)
+    message(FATAL_ERROR "${IMAGE}: ${IMAGE_SIZE} bytes, limit ${LIMIT} bytes")
+endif()
+message(STATUS "${IMAGE}: ${IMAGE_SIZE} of ${LIMIT} bytes (${IMAGE_FREE} free)")
@@ -13,45 +13,46 @@
 #define TIME_MS_FOR_SETTINGS                                                   \
   20000 ///< Время в мс для проверки бездействия кнопок в режиме меню (20 с)
 
-/* Протокол UIM_6100 (CAN) */
-#if PROTOCOL_UIM_6100 && !DEMO_MODE && !TEST_MODE
+/// Протоколы, собранные в образ (USE_MODE), - реестр protocol_selection.c
+#define IS_PROTOCOL_BUILD (PROTOCOL_UIM_6100)
+
+/* Протоколы (выбор при запуске - protocol_selection.c) */
+#if IS_PROTOCOL_BUILD && !DEMO_MODE && !TEST_MODE
 
 #include "can.h"
+#include "display_sync.h"
+#include "link_health.h"
 #include "protocol_selection.h"
+#include "scheduler.h"
+#include "sound.h"
+#include "startup.h"
+
+#if PROTOCOL_UIM_6100
 #include "uim6100.h"
+#endif
 
-#define PROTOCOL_NAME "SHK"
 #define ADDR_ID_MIN 1
 #define ADDR_ID_LIMIT 49
 #define MAX_POSITIVE_NUMBER_FLOOR 40
-#define MAIN_CABIN_ID UIM6100_MAIN_CABIN_CAN_ID
+#define MAIN_CABIN_ID 46 ///< Адрес кабинного индикатора
 #define TIME_MS_FOR_INTERFACE_CONNECTION                                       \
-  3000 ///< Время в мс для проверки подключения интерфейса (3 с)
-
-#define BUFFER_SIZE_BYTES 6
+  3000 ///< Время потери связи в мс, пока период кадров не определен (3 с)
 
 /* DEMO_MODE */
-#elif DEMO_MODE && !PROTOCOL_UIM_6100 && !TEST_MODE
+#elif DEMO_MODE && !IS_PROTOCOL_BUILD && !TEST_MODE
 
 #include "demo_mode.h"
 
-#define BUFFER_SIZE_BYTES 1
-
 /* TEST_MODE */
-#elif TEST_MODE && !DEMO_MODE && !PROTOCOL_UIM_6100
+#elif TEST_MODE && !DEMO_MODE && !IS_PROTOCOL_BUILD
 
 #include "test_mode.h"
 
-#define BUFFER_SIZE_BYTES 8
-
 #else
 #error "Wrong configurations!"
 #endif
 
 /* Общие переменные, определенные глобально в main.c */
-/// Счетчики для проверки подключения интерфейса CAN/UART/DATA_Pin
-extern volatile uint32_t alive_cnt[2];
-
 /// Флаг для состояния подключения интерфейса CAN/UART/DATA_Pin
 extern volatile bool is_interface_connected;
 
@@ -0,0 +1,215 @@
+/**
+ * @file diagnostics.c
+ */
+#include "diagnostics.h"
+
+#include "config.h"
+#include "isr_budget.h"
+
+_Static_assert(TASKS_COUNT <= DIAGNOSTICS_FIELDS_MAX &&
+                   ISR_ID_COUNT <= DIAGNOSTICS_FIELDS_MAX,
+               "Diagnostics item number holds 4 bits");
+_Static_assert(STARTUP_STEPS_COUNT + 4 <= DIAGNOSTICS_FIELDS_MAX,
+               "Startup record does not fit diagnostics fields");
+
+/**
+ * @brief  Поля записи FW_DIAG_TASK.
+ * @param  item:   Задача task_id_t.
+ * @param  fields: Массив полей (DIAGNOSTICS_FIELDS_MAX).
+ * @retval Кол-во полей (0 - нет элемента).
+ */
+static uint8_t read_task(uint8_t item, uint32_t *fields) {
+  if (item >= TASKS_COUNT) {
+    return 0;
+  }
+
+  task_stats_t stats;
+  scheduler_get_stats((task_id_t)item, &stats);
+
+  fields[0] = stats.runs;
+  fields[1] = stats.run_us;
+  fields[2] = stats.max_run_us;
+  fields[3] = stats.max_response_us;
+  fields[4] = stats.deadline_misses;
+  return 5;
+}
+
+/**
+ * @brief  Поля записи FW_DIAG_DISPLAY_SYNC.
+ * @param  fields: Массив полей (DIAGNOSTICS_FIELDS_MAX).
+ * @retval Кол-во полей.
+ */
+static uint8_t read_display_sync(uint32_t *fields) {
+  display_sync_stats_t stats;
+  display_sync_get_stats(&stats);
+
+  fields[0] = stats.frames;
+  fields[1] = stats.updates;
+  fields[2] = stats.phase_error_us;
+  fields[3] = stats.latency_us;
+  fields[4] = stats.max_latency_us;
+  fields[5] = stats.first_rx_us;
+  fields[6] = stats.first_update_us;
+  return 7;
+}
+
+/**
+ * @brief  Поля записи FW_DIAG_LINK.
+ * @param  fields: Массив полей (DIAGNOSTICS_FIELDS_MAX).
+ * @retval Кол-во полей.
+ */
+static uint8_t read_link(uint32_t *fields) {
+  link_health_stats_t stats;
+  link_health_get_stats(&stats);
+
+  fields[0] = stats.frames;
+  fields[1] = stats.period_ms;
+  fields[2] = stats.jitter_ms;
+  fields[3] = stats.max_jitter_ms;
+  fields[4] = stats.losses;
+  return 5;
+}
+
+/**
+ * @brief  Поля записи FW_DIAG_CAN: восстановление после bus-off, затем метки
+ *         времени кадров протокола.
+ * @param  fields: Массив полей (DIAGNOSTICS_FIELDS_MAX).
+ * @retval Кол-во полей.
+ */
+static uint8_t read_can(uint32_t *fields) {
+  can_recovery_stats_t recovery;
+  can_get_recovery_stats(&recovery);
+
+  can_rx_timing_t timing;
+  can_get_rx_timing(&timing);
+
+  fields[0] = recovery.bus_off_count;
+  fields[1] = recovery.last_recovery_ms;
+  fields[2] = recovery.max_recovery_ms;
+  fields[3] = timing.last_frame_us;
+  fields[4] = timing.decode_us;
+  fields[5] = timing.max_decode_us;
+  return 6;
+}
+
+#if PROTOCOL_UIM_6100
+/**
+ * @brief  Поля записи FW_DIAG_PROTOCOL (статистика UIM6100).
+ * @param  fields: Массив полей (DIAGNOSTICS_FIELDS_MAX).
+ * @retval Кол-во полей.
+ */
+static uint8_t read_protocol(uint32_t *fields) {
+  uim6100_stats_t stats;
+  uim6100_get_stats(&stats);
+
+  fields[0] = stats.frames;
+  fields[1] = stats.decode_us;
+  fields[2] = stats.max_decode_us;
+  fields[3] = stats.event_latency_us;
+  fields[4] = stats.max_event_latency_us;
+  return 5;
+}
+#endif
+
+#if ISR_BUDGET_CHECK
+/**
+ * @brief  Поля записи FW_DIAG_ISR.
+ * @param  item:   Обработчик isr_id_t.
+ * @param  fields: Массив полей (DIAGNOSTICS_FIELDS_MAX).
+ * @retval Кол-во полей (0 - нет элемента).
+ */
+static uint8_t read_isr(uint8_t item, uint32_t *fields) {
+  if (item >= ISR_ID_COUNT) {
+    return 0;
+  }
+
+  fields[0] = isr_budget_get_max_us((isr_id_t)item);
+  return 1;
+}
+#endif
+
+/**
+ * @brief  Поля записи FW_DIAG_STARTUP: время шагов, затем время до первого
+ *         этажа.
+ * @param  fields: Массив полей (DIAGNOSTICS_FIELDS_MAX).
+ * @retval Кол-во полей.
+ */
+static uint8_t read_startup(uint32_t *fields) {
+  startup_stats_t stats;
+  startup_get_stats(&stats);
+
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < STARTUP_STEPS_COUNT; i++) {
+    fields[count++] = stats.step_us[i];
+  }
+  fields[count++] = stats.ready_ms;
+  fields[count++] = stats.first_floor_ms;
+  fields[count++] = stats.frame_to_floor_us;
+  fields[count++] = stats.is_target_met;
+  return count;
+}
+
+/**
+ * @brief  Чтение одного поля статистики (команда FW_CMD_DIAG).
+ * @note   Запись читается целиком геттером модуля (копия под запретом
+ *         прерываний), затем выбирается поле.
+ * @param  record: Запись fw_diag_record_t.
+ * @param  item:   Элемент записи (0 - для записей без элементов).
+ * @param  field:  Номер поля.
+ * @param  value:  Указатель для значения поля.
+ * @retval true, если поле есть; false - нет записи, элемента или поля.
+ */
+bool diagnostics_read(uint8_t record, uint8_t item, uint8_t field,
+                      uint32_t *value) {
+  uint32_t fields[DIAGNOSTICS_FIELDS_MAX];
+  uint8_t count = 0;
+
+  bool has_items = record == FW_DIAG_TASK || record == FW_DIAG_ISR;
+  if (!has_items && item != 0) {
+    return false;
+  }
+
+  switch (record) {
+  case FW_DIAG_TASK:
+    count = read_task(item, fields);
+    break;
+
+  case FW_DIAG_DISPLAY_SYNC:
+    count = read_display_sync(fields);
+    break;
+
+  case FW_DIAG_LINK:
+    count = read_link(fields);
+    break;
+
+  case FW_DIAG_CAN:
+    count = read_can(fields);
+    break;
+
+#if PROTOCOL_UIM_6100
+  case FW_DIAG_PROTOCOL:
+    count = read_protocol(fields);
+    break;
+#endif
+
+#if ISR_BUDGET_CHECK
+  case FW_DIAG_ISR:
+    count = read_isr(item, fields);
+    break;
+#endif
+
+  case FW_DIAG_STARTUP:
+    count = read_startup(fields);
+    break;
+
+  default:
+    break;
+  }
+
+  if (field >= count) {
+    return false;
+  }
+
+  *value = fields[field];
+  return true;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file    diagnostics.h
+ * @brief   Этот файл содержит прототипы функций для файла diagnostics.c
+ */
+#ifndef __DIAGNOSTICS_H__
+#define __DIAGNOSTICS_H__
+
+#include "fw_update_protocol.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DIAGNOSTICS_FIELDS_MAX                                                 \
+  (FW_DIAG_FIELD_MASK + 1) ///< Кол-во полей записи (номер поля - 4 бита)
+
+/**
+ * @brief  Чтение одного поля статистики (команда FW_CMD_DIAG).
+ * @note   Поля записи fw_diag_record_t (значения uint32_t) в порядке полей
+ *         структуры статистики:
+ *         1. FW_DIAG_TASK (элемент - task_id_t) - task_stats_t;
+ *         2. FW_DIAG_DISPLAY_SYNC - display_sync_stats_t;
+ *         3. FW_DIAG_LINK - link_health_stats_t;
+ *         4. FW_DIAG_CAN - can_recovery_stats_t, затем can_rx_timing_t;
+ *         5. FW_DIAG_PROTOCOL - статистика протокола (uim6100_stats_t);
+ *         6. FW_DIAG_ISR (элемент - isr_id_t, только ISR_BUDGET_CHECK) -
+ *            максимальное время обработчика в мкс;
+ *         7. FW_DIAG_STARTUP - startup_stats_t (step_us[] - по полю на
+ *            шаг).
+ * @param  record: Запись fw_diag_record_t.
+ * @param  item:   Элемент записи (0 - для записей без элементов).
+ * @param  field:  Номер поля.
+ * @param  value:  Указатель для значения поля.
+ * @retval true, если поле есть; false - нет записи, элемента или поля.
+ */
+bool diagnostics_read(uint8_t record, uint8_t item, uint8_t field,
+                      uint32_t *value);
+
+#endif /* __DIAGNOSTICS_H__ */
@@ -28,6 +28,14 @@
 
 #include "button.h"
 #include "config.h"
+#if !DEMO_MODE && !TEST_MODE
+#include "conf.h" // Для номера версии ПО (из файла config.h.in)
+#include "drawing.h"
+#endif
+#include "irq_priority.h"
+#include "isr_budget.h"
+#include "timebase.h"
+#include "watchdog.h"
 
 /* USER CODE END Includes */
 
@@ -64,15 +72,13 @@ void SystemClock_Config(void);
 #if !DEMO_MODE && !TEST_MODE
 
 /// Настройки индикатора: адрес индикатора и уровень громкости пассивного бузера
-settings_t matrix_settings = {.addr_id = MAIN_CABIN_ID, .volume = VOLUME_1};
+settings_t matrix_settings = {.addr_id = MAIN_CABIN_ID,
+                              .volume = VOLUME_1,
+                              .can_bitrate = CAN_BITRATE_UNKNOWN,
+                              .protocol = PROTOCOL_ID_UNKNOWN};
 
 #endif
 
-/// Счетчики для проверки подключения интерфейса CAN/UART/DATA_Pin
-volatile uint32_t alive_cnt[2] = {
-    0,
-};
-
 /// Флаг для состояния подключения интерфейса CAN/UART/DATA_Pin
 volatile bool is_interface_connected = true;
 
@@ -87,6 +93,186 @@ menu_state_t menu_state = MENU_STATE_OPEN;
 /// Строка для отображения на матрице
 char matrix_string[3];
 
+#if !DEMO_MODE && !TEST_MODE
+
+/**
+ * @brief  Задача отображения: одна строка развертки (событие - граница
+ *         строки TIM4).
+ * @note   В рабочем режиме - заставка до первого этажа, затем этаж
+ *         протокола, в меню - строка режима или значения меню.
+ * @param  None
+ * @retval None
+ */
+static void task_display(void) {
+  if (matrix_state == MATRIX_STATE_WORKING) {
+    char *splash = startup_splash_string();
+    if (splash != NULL) {
+      draw_string_row(splash);
+    } else {
+      protocol_draw();
+    }
+  } else if (matrix_state == MATRIX_STATE_MENU) {
+    char *string = menu_display_string();
+    if (string != NULL) {
+      draw_string_row(string);
+    }
+  }
+}
+
+/**
+ * @brief  Задача протокола: запуск протокола, обработка кадров и остановка
+ *         протокола при входе в меню (события - принятый кадр, кнопки).
+ * @param  None
+ * @retval None
+ */
+static void task_protocol(void) {
+  switch (matrix_state) {
+  case MATRIX_STATE_START:
+    protocol_start();
+    matrix_state = MATRIX_STATE_WORKING;
+    break;
+
+  case MATRIX_STATE_WORKING:
+    protocol_process_data();
+    break;
+
+  case MATRIX_STATE_MENU:
+    if (menu_state == MENU_STATE_OPEN) {
+      protocol_stop();
+      menu_state = MENU_STATE_WORKING;
+      scheduler_notify(TASK_MENU);
+    }
+    break;
+  }
+}
+
+/**
+ * @brief  Задача звука: арбитр звуков (завершение и очередь звуков).
+ * @param  None
+ * @retval None
+ */
+static void task_sound(void) {
+  if (matrix_state == MATRIX_STATE_WORKING) {
+    sound_process();
+  }
+}
+
+/**
+ * @brief  Задача меню: обработка нажатий кнопок (событие - кнопки).
+ * @note   Выход из меню - событие для задачи сохранения настроек.
+ * @param  None
+ * @retval None
+ */
+static void task_menu(void) {
+  if (matrix_state != MATRIX_STATE_MENU || menu_state != MENU_STATE_WORKING) {
+    return;
+  }
+
+  press_button();
+
+  if (menu_state == MENU_STATE_CLOSE) {
+    scheduler_notify(TASK_SETTINGS);
+  }
+}
+
+/**
+ * @brief  Задача сохранения настроек во flash-память (событие - выход из
+ *         меню), затем перезапуск протокола.
+ * @param  None
+ * @retval None
+ */
+static void task_settings(void) {
+  if (matrix_state != MATRIX_STATE_MENU || menu_state != MENU_STATE_CLOSE) {
+    return;
+  }
+
+  overwrite_settings(&matrix_settings);
+  matrix_state = MATRIX_STATE_START;
+  menu_state = MENU_STATE_OPEN;
+  scheduler_notify(TASK_PROTOCOL);
+}
+
+/// Задачи индикатора (индекс - task_id_t, приоритет по убыванию)
+static const task_t tasks[TASKS_COUNT] = {
+    [TASK_DISPLAY] = {"display", task_display, 0, 1000},
+    [TASK_PROTOCOL] = {"protocol", task_protocol, 1, 2000},
+    [TASK_SOUND] = {"sound", task_sound, 5, 5000},
+    [TASK_MENU] = {"menu", task_menu, 10, 20000},
+    [TASK_SETTINGS] = {"settings", task_settings, 0, 100000},
+};
+
+/// Протокол, выбранный при запуске (STARTUP_PROTOCOL)
+static const protocol_t *protocol = NULL;
+
+/// Строки заставки: имя протокола, версия ПО (conf.h)
+static char *splash_strings[] = {NULL, PROJECT_VER};
+
+/**
+ * @brief  Шаг запуска: чтение настроек из flash.
+ * @param  None
+ * @retval None
+ */
+static void step_settings(void) { read_settings(&matrix_settings); }
+
+/**
+ * @brief  Шаг запуска: выбор протокола по настройкам (автоопределение, если
+ *         протокол не сохранен).
+ * @param  None
+ * @retval None
+ */
+static void step_protocol(void) { protocol = protocol_select(); }
+
+/**
+ * @brief  Шаг запуска: заставка (отображается задачей отображения, не
+ *         задерживает инициализацию и прием кадров).
+ * @param  None
+ * @retval None
+ */
+static void step_splash(void) {
+  splash_strings[0] = protocol->name;
+  startup_splash_start(splash_strings,
+                       sizeof(splash_strings) / sizeof(splash_strings[0]));
+}
+
+/**
+ * @brief  Шаг запуска: инициализация интерфейса протокола (CAN или DATA_Pin,
+ *         автоопределение скорости CAN, если она не сохранена).
+ * @param  None
+ * @retval None
+ */
+static void step_interface(void) { protocol_init(); }
+
+/**
+ * @brief  Шаг запуска: запуск приема кадров протокола (фильтр CAN) до
+ *         главного цикла, кадры принимаются во время заставки.
+ * @param  None
+ * @retval None
+ */
+static void step_reception(void) {
+  protocol_start();
+  matrix_state = MATRIX_STATE_WORKING;
+}
+
+/// Шаги запуска (индекс - startup_step_id_t) и их зависимости
+static const startup_step_t startup_steps[STARTUP_STEPS_COUNT] = {
+    [STARTUP_SETTINGS] = {"settings", step_settings, 0},
+    [STARTUP_PROTOCOL] = {"protocol", step_protocol,
+                          STARTUP_DEP(STARTUP_SETTINGS)},
+    [STARTUP_SPLASH] = {"splash", step_splash, STARTUP_DEP(STARTUP_PROTOCOL)},
+    [STARTUP_INTERFACE] = {"interface", step_interface,
+                           STARTUP_DEP(STARTUP_PROTOCOL)},
+    [STARTUP_RECEPTION] = {"reception", step_reception,
+                           STARTUP_DEP(STARTUP_INTERFACE)},
+};
+
+/// Задачи под контролем IWDG: запускаются чаще WATCHDOG_TIMEOUT_MS в любом
+/// состоянии (TASK_SETTINGS - только по событию)
+static const uint8_t supervised_tasks = (1U << TASK_DISPLAY) |
+                                        (1U << TASK_PROTOCOL) |
+                                        (1U << TASK_SOUND) | (1U << TASK_MENU);
+
+#endif
+
 /* USER CODE END 0 */
 
 /**
@@ -105,7 +291,7 @@ int main(void) {
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+  HAL_NVIC_SetPriorityGrouping(IRQ_PRIORITY_GROUP); // См. irq_priority.h
   /* USER CODE END Init */
 
   /* Configure the system clock */
@@ -122,7 +308,11 @@ int main(void) {
   MX_TIM4_Init();
   MX_TIM1_Init();
 
+  timebase_start();                   // Шкала времени 1 мкс (TIM1 + TIM3)
   TIM4_Start(PRESCALER_FOR_US, 1000); // 1 мс
+#if ISR_BUDGET_CHECK
+  isr_budget_init();
+#endif
 
 #if TEST_MODE
   test_mode_start();
@@ -137,48 +327,13 @@ int main(void) {
   }
 
 #else
-#include "conf.h" // Для номера версии ПО (из файла config.h.in)
-#include "drawing.h"
-
-  display_symbols_during_ms(PROTOCOL_NAME);
-  display_symbols_during_ms(PROJECT_VER);
 
-  read_settings(&matrix_settings);
-  protocol_init();
+  watchdog_record_reset_cause();
+  startup_run(startup_steps);
 
-  while (1) {
-    switch (matrix_state) {
-    case MATRIX_STATE_START:
-      protocol_start();
-      matrix_state = MATRIX_STATE_WORKING;
-      break;
-
-    case MATRIX_STATE_WORKING:
-      protocol_process_data();
-      break;
-
-    case MATRIX_STATE_MENU:
-
-      switch (menu_state) {
-      case MENU_STATE_OPEN:
-        protocol_stop();
-        menu_state = MENU_STATE_WORKING;
-        break;
-
-      case MENU_STATE_WORKING:
-        press_button();
-        break;
-
-      case MENU_STATE_CLOSE:
-        overwrite_settings(&matrix_settings);
-        matrix_state = MATRIX_STATE_START;
-        menu_state = MENU_STATE_OPEN;
-        break;
-      }
-
-      break;
-    }
-  }
+  scheduler_init(tasks);
+  watchdog_start(supervised_tasks); // После автоопределения скорости CAN
+  scheduler_run();
 
 #endif
 
@@ -202,7 +357,7 @@ void SystemClock_Config(void) {
   RCC_OscInitStruct.HSIState = RCC_HSI_ON;
   RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
   RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
-  RCC_OscInitStruct.PLL.PLLMUL = RCC_PLL_MUL8;
+  RCC_OscInitStruct.PLL.PLLMUL = SYSCLK_RCC_PLL_MUL; // См. SYSCLK_FREQ
   if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
     Error_Handler();
   }
@@ -213,10 +368,10 @@ void SystemClock_Config(void) {
                                 RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
   RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
   RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
-  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
-  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV4;
 
-  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_2) != HAL_OK) {
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, SYSCLK_FLASH_LATENCY) != HAL_OK) {
     Error_Handler();
   }
 }
@@ -5,59 +5,134 @@
 
 #include "config.h"
 #include "drawing.h"
+#include "timer_wheel.h"
+
+#include <stddef.h>
+
+/// Реестр протоколов, собранных в образ (USE_MODE в CMakeLists.txt)
+static const protocol_t *const protocols[] = {
+#if PROTOCOL_UIM_6100
+    &uim6100_protocol,
+#endif
+};
+
+#define PROTOCOLS_COUNT (sizeof(protocols) / sizeof(protocols[0]))
+
+_Static_assert(PROTOCOLS_COUNT > 0, "No protocol in the image");
+
+/// Выбранный протокол (protocol_select())
+static const protocol_t *active_protocol = NULL;
+
+/// Флаг восстановления связи (последний проход protocol_process_data()).
+static bool is_link_recovering = false;
+
+/// Таймер проверки связи (запущен между protocol_start() и protocol_stop()).
+static timer_wheel_timer_t link_check_timer;
+
+/**
+ * @brief  Проверка подключения интерфейса по времени последнего кадра (колбек
+ *         link_check_timer, период LINK_HEALTH_CHECK_PERIOD_MS).
+ * @param  None
+ * @retval None
+ */
+static void link_check_elapsed() {
+  extern matrix_state_t matrix_state;
+
+  if (matrix_state == MATRIX_STATE_WORKING) {
+    if (!link_health_check(HAL_GetTick())) {
+      is_interface_connected = false;
+    }
+  }
+}
+
+/**
+ * @brief  Проверка адреса индикатора из настроек.
+ * @param  None
+ * @retval true, если адрес в диапазоне ADDR_ID_MIN..ADDR_ID_LIMIT.
+ */
+static bool is_addr_id_valid() {
+  return matrix_settings.addr_id >= ADDR_ID_MIN &&
+         matrix_settings.addr_id <= ADDR_ID_LIMIT;
+}
+
+/**
+ * @brief  Выбор протокола по настройкам (settings_t.protocol).
+ * @note   Если протокол не выбран или не собран в образ - выбирается первый
+ *         протокол реестра.
+ * @param  None
+ * @retval Указатель на описание выбранного протокола.
+ */
+const protocol_t *protocol_select() {
+  active_protocol = protocols[0];
+
+  for (size_t i = 0; i < PROTOCOLS_COUNT; i++) {
+    if (protocols[i]->id == matrix_settings.protocol) {
+      active_protocol = protocols[i];
+      break;
+    }
+  }
+
+  matrix_settings.protocol = active_protocol->id;
+  return active_protocol;
+}
 
 /**
  * @brief  Инициализация интерфейса для протокола.
+ * @note   Некорректный адрес из flash заменяется адресом кабинного
+ *         индикатора.
  * @param  None
  * @retval None
  */
 void protocol_init() {
-  bool is_id_from_flash_valid = matrix_settings.addr_id >= ADDR_ID_MIN &&
-                                matrix_settings.addr_id <= ADDR_ID_LIMIT;
-
-  if (!is_id_from_flash_valid) {
+  if (!is_addr_id_valid()) {
     matrix_settings.addr_id = MAIN_CABIN_ID;
     matrix_settings.volume = VOLUME_1;
   }
 
-#if PROTOCOL_UIM_6100
-  MX_CAN_Init();
-#endif
+  active_protocol->init();
 }
 
 /**
  * @brief   Запуск обработки протокола (запуск интерфейса).
+ * @note   Синхронизация отображения сбрасывается: до первого кадра
+ *         отображается строка matrix_string (display_sync_reset()). Связь
+ *         проверяется каждые LINK_HEALTH_CHECK_PERIOD_MS мс
+ *         (link_check_timer).
  * @param  None
  * @retval None
  */
 void protocol_start() {
-#if PROTOCOL_UIM_6100
+  display_sync_reset(matrix_string);
 
-  bool is_id_from_flash_valid = matrix_settings.addr_id >= ADDR_ID_MIN &&
-                                matrix_settings.addr_id <= ADDR_ID_LIMIT;
-
-  if (is_id_from_flash_valid) {
-    start_can(&hcan, matrix_settings.addr_id);
-  } else {
-    start_can(&hcan, MAIN_CABIN_ID);
-  }
-#endif
+  active_protocol->start();
+  timer_wheel_start_periodic(&link_check_timer, LINK_HEALTH_CHECK_PERIOD_MS,
+                             link_check_elapsed);
 }
 
 /**
- * @brief  Обработка данных протокола, если интерфейс подключен, иначе
- *         отображается "--".
+ * @brief  Обработка протокола (задача протокола, не блокирует): связь и
+ *         события принятых кадров (process() выбранного протокола).
  * @param  None
  * @retval None
  */
-
 void protocol_process_data() {
-  if (is_interface_connected) {
-#if PROTOCOL_UIM_6100
-    process_data_from_can();
-#endif
+  is_link_recovering = active_protocol->process();
+}
+
+/**
+ * @brief  Отображение протокола (задача отображения): одна строка развертки
+ *         строки, примененной на границе строки (display_sync_string()), если
+ *         интерфейс подключен, иначе - "c--".
+ * @note   Во время восстановления связи отображается последний известный
+ *         этаж.
+ * @param  None
+ * @retval None
+ */
+void protocol_draw() {
+  if (is_interface_connected || is_link_recovering) {
+    draw_string_row(display_sync_string());
   } else {
-    draw_string_on_matrix("c--");
+    draw_string_row("c--");
   }
 }
 
@@ -67,9 +142,8 @@ void protocol_process_data() {
  * @retval None
  */
 void protocol_stop() {
+  timer_wheel_stop(&link_check_timer);
   is_interface_connected = false;
 
-#if PROTOCOL_UIM_6100
-  stop_can(&hcan);
-#endif
+  active_protocol->stop();
 }
@@ -5,6 +5,41 @@
 #ifndef __PROTOCOL_SELECTION_H__
 #define __PROTOCOL_SELECTION_H__
 
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Идентификаторы протоколов (хранятся в settings_t.protocol). Значения не
+ * зависят от набора протоколов в образе и не изменяются.
+ */
+typedef enum {
+  PROTOCOL_ID_UIM_6100 = 0,   // УИМ6100 (ШК6000), CAN
+  PROTOCOL_ID_UNKNOWN = 0xFF // Протокол не выбран (стертая flash-память)
+} protocol_id_t;
+
+/**
+ * Описание протокола для реестра протоколов (const, во flash). Функции
+ * вызываются через указатели без ветвления по протоколу.
+ */
+typedef struct {
+  protocol_id_t id;      // Идентификатор протокола
+  char *name;            // Имя протокола при запуске индикатора ("SHK")
+  void (*init)(void);    // Инициализация интерфейса
+  void (*start)(void);   // Сброс состояния и запуск интерфейса
+  bool (*process)(void); // Проход задачи протокола, true - связь
+                         // восстанавливается (отображается последний этаж)
+  void (*stop)(void);    // Остановка интерфейса и звуков
+} protocol_t;
+
+/**
+ * @brief  Выбор протокола по настройкам (settings_t.protocol).
+ * @note   Если протокол не выбран или не собран в образ - выбирается первый
+ *         протокол реестра.
+ * @param  None
+ * @retval Указатель на описание выбранного протокола.
+ */
+const protocol_t *protocol_select();
+
 /**
  * @brief  Инициализация интерфейса для протокола.
  * @param  None
@@ -20,13 +55,21 @@ void protocol_init();
 void protocol_start();
 
 /**
- * @brief  Обработка данных протокола, если интерфейс подключен, иначе
- *         отображается "--".
+ * @brief  Обработка протокола (задача протокола, не блокирует): связь и
+ *         события принятых кадров.
  * @param  None
  * @retval None
  */
 void protocol_process_data();
 
+/**
+ * @brief  Отображение протокола (задача отображения): одна строка развертки
+ *         этажа, если интерфейс подключен, иначе - "c--".
+ * @param  None
+ * @retval None
+ */
+void protocol_draw();
+
 /**
  * @brief  Остановка обработки протокола.
  * @param  None
@@ -0,0 +1,263 @@
+/**
+ * @file scheduler.c
+ */
+#include "scheduler.h"
+
+#include "clock_governor.h"
+#include "main.h"
+#include "timebase.h"
+#include "watchdog.h"
+
+#include <stddef.h>
+
+_Static_assert(TASKS_COUNT <= 32, "Ready mask holds up to 32 tasks");
+_Static_assert(TASKS_COUNT <= 8, "Watchdog check-in mask holds up to 8 tasks");
+
+/// Таблица задач (scheduler_init()).
+static const task_t *task_table = NULL;
+
+/// Маска готовых задач (бит - task_id_t).
+static volatile uint32_t ready_mask = 0;
+
+/// Время в мкс, когда задача стала готовой (для времени отклика).
+static volatile uint32_t ready_us[TASKS_COUNT];
+
+/// Время последнего периодического запуска задачи в мс.
+static uint32_t release_ms[TASKS_COUNT];
+
+/// Статистика выполнения задач.
+static task_stats_t task_stats[TASKS_COUNT];
+
+/// Время сна (WFI) в текущем окне измерения в мкс.
+static uint32_t idle_us = 0;
+
+/// Начало окна измерения доли простоя в мс.
+static uint32_t idle_window_start_ms = 0;
+
+/// Доля простоя за последнее окно измерения в промилле (0..1000).
+static uint16_t idle_permille = 0;
+
+/**
+ * @brief  Установка готовности задачи (момент готовности - первое событие).
+ * @param  id: Задача.
+ * @retval None
+ */
+static void set_ready(task_id_t id) {
+  uint32_t bit = 1UL << id;
+
+  __disable_irq();
+  if ((ready_mask & bit) == 0) {
+    ready_us[id] = timebase_now_us();
+    ready_mask |= bit;
+  }
+  __enable_irq();
+}
+
+/**
+ * @brief  Готовность периодических задач по времени (HAL_GetTick).
+ * @param  None
+ * @retval None
+ */
+static void release_periodic_tasks() {
+  uint32_t now_ms = HAL_GetTick();
+
+  for (uint8_t id = 0; id < TASKS_COUNT; id++) {
+    uint16_t period_ms = task_table[id].period_ms;
+
+    if (period_ms != 0 && now_ms - release_ms[id] >= period_ms) {
+      release_ms[id] = now_ms;
+      set_ready(id);
+    }
+  }
+}
+
+/**
+ * @brief  Учет времени выполнения и отклика задачи.
+ * @param  id:        Задача.
+ * @param  ready_at:  Время готовности задачи в мкс.
+ * @param  start_us:  Время запуска задачи в мкс.
+ * @param  finish_us: Время завершения задачи в мкс.
+ * @retval None
+ */
+static void account_run(task_id_t id, uint32_t ready_at, uint32_t start_us,
+                        uint32_t finish_us) {
+  task_stats_t *stats = &task_stats[id];
+  uint32_t run_us = finish_us - start_us;
+  uint32_t response_us = finish_us - ready_at;
+
+  stats->runs++;
+  stats->run_us = run_us;
+  if (run_us > stats->max_run_us) {
+    stats->max_run_us = run_us;
+  }
+  if (response_us > stats->max_response_us) {
+    stats->max_response_us = response_us;
+  }
+  if (task_table[id].deadline_us != 0 &&
+      response_us > task_table[id].deadline_us) {
+    stats->deadline_misses++;
+  }
+}
+
+/**
+ * @brief  Инициализация планировщика: таблица задач.
+ * @note   Все задачи готовы к первому запуску. Время выполнения и отклика
+ *         считается по шкале времени 1 мкс (timebase_now_us()), общей с
+ *         метками времени кадров и отображения.
+ * @param  tasks: Таблица задач (TASKS_COUNT, индекс - task_id_t).
+ * @retval None
+ */
+void scheduler_init(const task_t *tasks) {
+  task_table = tasks;
+
+  uint32_t now_ms = HAL_GetTick();
+  for (uint8_t id = 0; id < TASKS_COUNT; id++) {
+    release_ms[id] = now_ms;
+    task_stats[id] = (task_stats_t){0, 0, 0, 0, 0};
+    set_ready(id);
+  }
+}
+
+/**
+ * @brief  Событие для задачи: задача готова к запуску (можно вызывать из
+ *         прерывания).
+ * @note   Повторные события до запуска задачи объединяются: задача
+ *         выполняется один раз, время отклика - от первого события.
+ * @param  id: Задача.
+ * @retval None
+ */
+void scheduler_notify(task_id_t id) {
+  if (id < TASKS_COUNT) {
+    set_ready(id);
+  }
+}
+
+/**
+ * @brief  Запуск одной готовой задачи с наивысшим приоритетом.
+ * @note   Задача выполняется до завершения (без вытеснения другими
+ *         задачами), поэтому время отклика задачи ограничено временем
+ *         выполнения одной задачи с более низким приоритетом и всех задач с
+ *         более высоким приоритетом. Завершение задачи - отметка для
+ *         сторожевого таймера (watchdog_checkin()).
+ * @param  None
+ * @retval true, если задача была запущена; false - готовых задач нет.
+ */
+bool scheduler_run_once(void) {
+  release_periodic_tasks();
+
+  if (ready_mask == 0) {
+    return false;
+  }
+
+  task_id_t id = 0;
+  while ((ready_mask & (1UL << id)) == 0) {
+    id++;
+  }
+
+  __disable_irq();
+  ready_mask &= ~(1UL << id);
+  uint32_t ready_at = ready_us[id];
+  __enable_irq();
+
+  uint32_t start_us = timebase_now_us();
+  task_table[id].run();
+  account_run(id, ready_at, start_us, timebase_now_us());
+  watchdog_checkin(id);
+
+  return true;
+}
+
+/**
+ * @brief  Сон (WFI) до прерывания, если готовых задач нет.
+ * @note   1. Готовность проверяется при запрещенных прерываниях: событие
+ *            scheduler_notify() после проверки не теряется, т.к. ожидающее
+ *            прерывание завершает WFI и при PRIMASK = 1, обработчик
+ *            выполняется после __enable_irq();
+ *         2. Будят прерывания CAN RX, EXTI кнопок, TIM4 (граница строки
+ *            развертки) и SysTick (периодические задачи);
+ *         3. Длительность сна считается по шкале времени 1 мкс: частота
+ *            ядра и период SysTick в тактах меняются (clock_governor.c),
+ *            частота таймеров шкалы времени - нет.
+ * @param  None
+ * @retval None
+ */
+static void enter_idle() {
+  __disable_irq();
+  if (ready_mask != 0) {
+    __enable_irq();
+    return;
+  }
+
+  uint32_t sleep_us = timebase_now_us();
+  HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+  sleep_us = timebase_elapsed_us(sleep_us);
+  __enable_irq();
+
+  idle_us += sleep_us;
+}
+
+/**
+ * @brief  Расчет доли простоя по окончании окна измерения
+ *         SCHEDULER_IDLE_WINDOW_MS и выбор частоты ядра.
+ * @note   Полная частота запрашивается при доле простоя ниже
+ *         SCHEDULER_BURST_IDLE_PERMILLE и снимается при доле выше
+ *         SCHEDULER_ECO_IDLE_PERMILLE (гистерезис: доля простоя на половинной
+ *         частоте меньше, чем на полной).
+ * @param  None
+ * @retval None
+ */
+static void update_idle_window() {
+  uint32_t elapsed_ms = HAL_GetTick() - idle_window_start_ms;
+
+  if (elapsed_ms < SCHEDULER_IDLE_WINDOW_MS) {
+    return;
+  }
+
+  uint32_t permille = idle_us / elapsed_ms;
+
+  idle_permille = permille > 1000 ? 1000 : permille;
+  idle_us = 0;
+  idle_window_start_ms += elapsed_ms;
+
+  if (idle_permille < SCHEDULER_BURST_IDLE_PERMILLE) {
+    clock_governor_request(CLOCK_BURST_LOAD);
+  } else if (idle_permille > SCHEDULER_ECO_IDLE_PERMILLE) {
+    clock_governor_release(CLOCK_BURST_LOAD);
+  }
+}
+
+/**
+ * @brief  Главный цикл планировщика (не возвращается).
+ * @note   Если готовых задач нет, ядро спит до прерывания (enter_idle()).
+ * @param  None
+ * @retval None
+ */
+void scheduler_run(void) {
+  idle_window_start_ms = HAL_GetTick();
+
+  while (1) {
+    if (!scheduler_run_once()) {
+      enter_idle();
+    }
+    update_idle_window();
+  }
+}
+
+/**
+ * @brief  Получение статистики выполнения задачи.
+ * @param  id:    Задача.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void scheduler_get_stats(task_id_t id, task_stats_t *stats) {
+  if (id < TASKS_COUNT) {
+    *stats = task_stats[id];
+  }
+}
+
+/**
+ * @brief  Получение доли простоя (сна) ядра за последнее окно измерения.
+ * @param  None
+ * @retval Доля простоя в промилле (0..1000).
+ */
+uint16_t scheduler_get_idle_permille(void) { return idle_permille; }
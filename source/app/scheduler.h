@@ -0,0 +1,97 @@
+/**
+ * @file    scheduler.h
+ * @brief   Этот файл содержит прототипы функций для файла scheduler.c
+ */
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCHEDULER_IDLE_WINDOW_MS                                               \
+  1000 ///< Окно измерения доли простоя (scheduler_get_idle_permille())
+#define SCHEDULER_BURST_IDLE_PERMILLE                                          \
+  250 ///< Доля простоя, ниже которой запрашивается полная частота ядра
+#define SCHEDULER_ECO_IDLE_PERMILLE                                            \
+  700 ///< Доля простоя, выше которой запрос полной частоты снимается
+
+/**
+ * Задачи индикатора (индекс - приоритет: 0 - наивысший). Задача выполняется
+ * до завершения и не блокирует.
+ */
+typedef enum {
+  TASK_DISPLAY = 0, // Развертка строки (граница строки TIM4)
+  TASK_PROTOCOL,    // Протокол: события кадров, связь, запуск/остановка
+  TASK_SOUND,       // Арбитр звуков
+  TASK_MENU,        // Меню (кнопки)
+  TASK_SETTINGS,    // Сохранение настроек во flash (выход из меню)
+  TASKS_COUNT
+} task_id_t;
+
+/**
+ * Описание задачи (const, во flash).
+ */
+typedef struct {
+  const char *name;     // Имя задачи (отладка)
+  void (*run)(void);    // Функция задачи (выполняется до завершения)
+  uint16_t period_ms;   // Период запуска в мс, 0 - только по событию
+  uint32_t deadline_us; // Допустимое время от готовности до завершения
+} task_t;
+
+/**
+ * Статистика выполнения задачи.
+ */
+typedef struct {
+  uint32_t runs;            // Кол-во запусков
+  uint32_t run_us;          // Время выполнения последнего запуска в мкс
+  uint32_t max_run_us;      // Максимальное время выполнения в мкс
+  uint32_t max_response_us; // Максимальное время от готовности до завершения
+  uint32_t deadline_misses; // Кол-во завершений позже deadline_us
+} task_stats_t;
+
+/**
+ * @brief  Инициализация планировщика: таблица задач.
+ * @param  tasks: Таблица задач (TASKS_COUNT, индекс - task_id_t).
+ * @retval None
+ */
+void scheduler_init(const task_t *tasks);
+
+/**
+ * @brief  Событие для задачи: задача готова к запуску (можно вызывать из
+ *         прерывания).
+ * @param  id: Задача.
+ * @retval None
+ */
+void scheduler_notify(task_id_t id);
+
+/**
+ * @brief  Запуск одной готовой задачи с наивысшим приоритетом.
+ * @param  None
+ * @retval true, если задача была запущена; false - готовых задач нет.
+ */
+bool scheduler_run_once(void);
+
+/**
+ * @brief  Главный цикл планировщика (не возвращается).
+ * @note   Если готовых задач нет, ядро спит до прерывания (WFI).
+ * @param  None
+ * @retval None
+ */
+void scheduler_run(void);
+
+/**
+ * @brief  Получение статистики выполнения задачи.
+ * @param  id:    Задача.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void scheduler_get_stats(task_id_t id, task_stats_t *stats);
+
+/**
+ * @brief  Получение доли простоя (сна) ядра за последнее окно измерения.
+ * @param  None
+ * @retval Доля простоя в промилле (0..1000).
+ */
+uint16_t scheduler_get_idle_permille(void);
+
+#endif /*__SCHEDULER_H__ */
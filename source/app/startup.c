@@ -0,0 +1,163 @@
+/**
+ * @file startup.c
+ */
+#include "startup.h"
+
+#include "display_sync.h"
+#include "main.h"
+#include "timebase.h"
+#include "timer_wheel.h"
+
+#include <stddef.h>
+
+_Static_assert(STARTUP_STEPS_COUNT <= 32, "Dependency mask holds 32 steps");
+
+/// Маска всех шагов запуска.
+#define STARTUP_ALL_STEPS ((1UL << STARTUP_STEPS_COUNT) - 1)
+
+/// Статистика запуска.
+static startup_stats_t startup_stats;
+
+/// Строки заставки (startup_splash_start()).
+static char *const *splash_strings = NULL;
+
+/// Кол-во строк заставки.
+static uint8_t splash_count = 0;
+
+/// Номер отображаемой строки заставки (splash_count - заставка завершена).
+static volatile uint8_t splash_index = 0;
+
+/// Таймер смены строки заставки.
+static timer_wheel_timer_t splash_timer;
+
+/// Флаг первого этажа (время зафиксировано в startup_stats).
+static bool is_first_floor_shown = false;
+
+/**
+ * @brief  Смена строки заставки (колбек splash_timer).
+ * @param  None
+ * @retval None
+ */
+static void splash_elapsed() {
+  if (splash_index < splash_count) {
+    splash_index++;
+  }
+  if (splash_index < splash_count) {
+    timer_wheel_start_once(&splash_timer, STARTUP_SPLASH_STRING_MS,
+                           splash_elapsed);
+  }
+}
+
+/**
+ * @brief  Поиск следующего шага: шаг не выполнен и все его зависимости
+ *         выполнены, из таких - шаг с меньшим индексом.
+ * @param  steps:     Таблица шагов.
+ * @param  done_mask: Маска выполненных шагов.
+ * @retval Номер шага или STARTUP_STEPS_COUNT (нет готовых шагов).
+ */
+static uint8_t next_ready_step(const startup_step_t *steps,
+                               uint32_t done_mask) {
+  for (uint8_t id = 0; id < STARTUP_STEPS_COUNT; id++) {
+    if ((done_mask & STARTUP_DEP(id)) == 0 &&
+        (steps[id].deps_mask & ~done_mask) == 0) {
+      return id;
+    }
+  }
+  return STARTUP_STEPS_COUNT;
+}
+
+/**
+ * @brief  Выполнение шагов запуска в порядке зависимостей.
+ * @note   Порядок определяется только таблицей (зависимости и индекс шага),
+ *         поэтому одинаков при каждом запуске. Время шагов - по шкале
+ *         времени 1 мкс. Цикл зависимостей - Error_Handler().
+ * @param  steps: Таблица шагов (STARTUP_STEPS_COUNT, индекс -
+ *                startup_step_id_t).
+ * @retval None
+ */
+void startup_run(const startup_step_t *steps) {
+  uint32_t done_mask = 0;
+
+  while (done_mask != STARTUP_ALL_STEPS) {
+    uint8_t id = next_ready_step(steps, done_mask);
+    if (id == STARTUP_STEPS_COUNT) {
+      Error_Handler();
+    }
+
+    uint32_t start_us = timebase_now_us();
+    steps[id].run();
+    startup_stats.step_us[id] = timebase_elapsed_us(start_us);
+    done_mask |= STARTUP_DEP(id);
+  }
+
+  startup_stats.ready_ms = HAL_GetTick();
+}
+
+/**
+ * @brief  Запуск заставки: строки по очереди, каждая
+ *         STARTUP_SPLASH_STRING_MS, до первого этажа.
+ * @note   Заставку отображает задача отображения (startup_splash_string()),
+ *         поэтому инициализация интерфейса и прием кадров не ждут ее
+ *         окончания.
+ * @param  strings: Строки заставки (указатели должны быть действительны до
+ *                  конца заставки).
+ * @param  count:   Кол-во строк.
+ * @retval None
+ */
+void startup_splash_start(char *const *strings, uint8_t count) {
+  splash_strings = strings;
+  splash_count = count;
+  splash_index = 0;
+
+  if (count != 0) {
+    timer_wheel_start_once(&splash_timer, STARTUP_SPLASH_STRING_MS,
+                           splash_elapsed);
+  }
+}
+
+/**
+ * @brief  Фиксация времени первого этажа (первая строка кадра протокола
+ *         применена на границе строки развертки, см. display_sync).
+ * @param  None
+ * @retval None
+ */
+static void check_first_floor() {
+  display_sync_stats_t sync;
+  display_sync_get_stats(&sync);
+
+  if (sync.updates == 0) {
+    return;
+  }
+
+  startup_stats.first_floor_ms = HAL_GetTick();
+  startup_stats.frame_to_floor_us = sync.first_update_us - sync.first_rx_us;
+  startup_stats.is_target_met =
+      startup_stats.frame_to_floor_us <= STARTUP_FIRST_FLOOR_TARGET_US;
+  is_first_floor_shown = true;
+
+  timer_wheel_stop(&splash_timer);
+  splash_index = splash_count;
+}
+
+/**
+ * @brief  Строка заставки для отображения (задача отображения).
+ * @note   Фиксирует время первого этажа: заставка завершается, как только
+ *         применена строка первого кадра протокола.
+ * @param  None
+ * @retval Указатель на строку или NULL (заставка завершена).
+ */
+char *startup_splash_string(void) {
+  if (!is_first_floor_shown) {
+    check_first_floor();
+  }
+
+  uint8_t index = splash_index;
+  return index < splash_count ? splash_strings[index] : NULL;
+}
+
+/**
+ * @brief  Получение статистики запуска.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void startup_get_stats(startup_stats_t *stats) { *stats = startup_stats; }
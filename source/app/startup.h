@@ -0,0 +1,86 @@
+/**
+ * @file    startup.h
+ * @brief   Этот файл содержит прототипы функций для файла startup.c
+ */
+#ifndef __STARTUP_H__
+#define __STARTUP_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define STARTUP_SPLASH_STRING_MS                                               \
+  3000 ///< Время отображения одной строки заставки (до первого этажа)
+#define STARTUP_FIRST_FLOOR_TARGET_US                                          \
+  200000 ///< Цель: от первого кадра протокола до отображения этажа (200 мс)
+
+/**
+ * Шаги запуска индикатора (индекс - порядок выполнения готовых шагов: из
+ * готовых шагов выполняется шаг с меньшим индексом).
+ */
+typedef enum {
+  STARTUP_SETTINGS = 0, // Чтение настроек из flash
+  STARTUP_PROTOCOL,     // Выбор (автоопределение) протокола
+  STARTUP_SPLASH,       // Запуск заставки: имя протокола, версия ПО
+  STARTUP_INTERFACE,    // Инициализация интерфейса (CAN или DATA_Pin)
+  STARTUP_RECEPTION,    // Запуск приема кадров протокола (фильтр CAN)
+  STARTUP_STEPS_COUNT
+} startup_step_id_t;
+
+/// Маска зависимости от шага (startup_step_t.deps_mask).
+#define STARTUP_DEP(id) (1UL << (id))
+
+/**
+ * Описание шага запуска (const, во flash).
+ */
+typedef struct {
+  const char *name;   // Имя шага (отладка)
+  void (*run)(void);  // Функция шага (не блокирует, кроме автоопределения)
+  uint32_t deps_mask; // Шаги, которые выполняются раньше (STARTUP_DEP())
+} startup_step_t;
+
+/**
+ * Статистика запуска.
+ */
+typedef struct {
+  uint32_t step_us[STARTUP_STEPS_COUNT]; // Время выполнения шага в мкс
+  uint32_t ready_ms;                     // Шаги выполнены (HAL_GetTick)
+  uint32_t first_floor_ms;               // Первый этаж (HAL_GetTick), 0 - нет
+  uint32_t frame_to_floor_us;            // От приема 1-го кадра до этажа
+  bool is_target_met;                    // frame_to_floor_us в пределах цели
+} startup_stats_t;
+
+/**
+ * @brief  Выполнение шагов запуска в порядке зависимостей.
+ * @param  steps: Таблица шагов (STARTUP_STEPS_COUNT, индекс -
+ *                startup_step_id_t).
+ * @retval None
+ */
+void startup_run(const startup_step_t *steps);
+
+/**
+ * @brief  Запуск заставки: строки по очереди, каждая
+ *         STARTUP_SPLASH_STRING_MS, до первого этажа.
+ * @param  strings: Строки заставки (указатели должны быть действительны до
+ *                  конца заставки).
+ * @param  count:   Кол-во строк.
+ * @retval None
+ */
+void startup_splash_start(char *const *strings, uint8_t count);
+
+/**
+ * @brief  Строка заставки для отображения (задача отображения).
+ * @note   Фиксирует время первого этажа: заставка завершается, как только
+ *         применена строка первого кадра протокола.
+ * @param  None
+ * @retval Указатель на строку или NULL (заставка завершена).
+ */
+char *startup_splash_string(void);
+
+/**
+ * @brief  Получение статистики запуска.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void startup_get_stats(startup_stats_t *stats);
+
+#endif /* __STARTUP_H__ */
@@ -0,0 +1,303 @@
+/**
+ * @file    bootloader.c
+ * @brief   Загрузчик: запуск приложения, обновление ПО по CAN.
+ * @note    Загрузчик расположен в начале flash-памяти (область BOOT), при
+ *          запуске:
+ *          1. Запрос обновления не получен, проверенного образа нет, а в
+ *             области APP есть приложение - сразу запуск приложения;
+ *          2. Проверенный образ есть (страница META) - копирование образа в
+ *             APP и перезапуск;
+ *          3. Иначе - прием образа по CAN (fw_update.c). Если от ПК нет
+ *             кадров BOOT_IDLE_TIMEOUT_MS, а приложение есть - перезапуск.
+ */
+#include "fw_update.h"
+#include "main.h"
+
+#include <stdbool.h>
+
+#define BOOT_IDLE_TIMEOUT_MS                                                   \
+  30000 ///< Время ожидания ПК до возврата в приложение в мс
+#define BOOT_DEFAULT_ADDR_ID                                                   \
+  46 ///< Адрес, если адрес не сохранен (кабинный индикатор УИМ6100)
+#define BOOT_ADDR_ID_LIMIT 49 ///< Максимальный адрес (ADDR_ID_LIMIT УИМ6100)
+#define BOOT_DEFAULT_PRESCALER                                                 \
+  CAN_PRESCALER(200000) ///< Прескелер CAN, если скорость не сохранена
+#define BOOT_TX_TIMEOUT_MS 10 ///< Время ожидания свободного mailbox в мс
+#define FILTER_11_BIT_ID_OFFSET                                                \
+  5 ///< Смещение для стандартного фильтра идентификации кадра.
+
+/* Области памяти (из STM32F103CBTX_BOOT.ld) */
+extern uint32_t __APP_START;
+extern uint32_t __APP_SIZE;
+extern uint32_t __SETTINGS_SECTION_START;
+extern uint32_t _estack;
+
+/// Запрос загрузчика от приложения (сохраняется при перезапуске).
+static volatile uint32_t boot_request
+    __attribute__((__section__(".noinit"), used));
+
+/**
+ * Прескелеры для скоростей can_bitrate_t (как в can.c приложения:
+ * 200, 125, 250 кбит/с, бит - CAN_TQ_PER_BIT квантов, см. main.h).
+ */
+static const uint16_t can_prescalers[] = {
+    CAN_PRESCALER(200000), CAN_PRESCALER(125000), CAN_PRESCALER(250000)};
+
+CAN_HandleTypeDef hcan;
+
+/// Адрес индикатора из настроек приложения.
+static uint8_t addr_id = BOOT_DEFAULT_ADDR_ID;
+
+/**
+ * @brief  Проверка приложения в области APP.
+ * @note   Указатель стека должен быть в RAM, вектор сброса - в области APP.
+ * @param  None
+ * @retval true, если приложение можно запустить.
+ */
+static bool is_app_valid(void) {
+  uint32_t app_start = (uint32_t)&__APP_START;
+  uint32_t stack_ptr = *(volatile uint32_t *)app_start;
+  uint32_t reset_handler = *(volatile uint32_t *)(app_start + 4);
+
+  return stack_ptr > SRAM_BASE && stack_ptr <= (uint32_t)&_estack &&
+         reset_handler > app_start &&
+         reset_handler < app_start + (uint32_t)&__APP_SIZE;
+}
+
+/**
+ * @brief  Запуск приложения (только сразу после сброса, до HAL_Init).
+ * @param  None
+ * @retval None
+ */
+static void jump_to_app(void) {
+  uint32_t app_start = (uint32_t)&__APP_START;
+  uint32_t stack_ptr = *(volatile uint32_t *)app_start;
+  void (*reset_handler)(void) =
+      (void (*)(void))(*(volatile uint32_t *)(app_start + 4));
+
+  SCB->VTOR = app_start;
+  __set_MSP(stack_ptr);
+  reset_handler();
+}
+
+/**
+ * @brief  Чтение адреса и скорости CAN из настроек приложения.
+ * @note   Формат слова настроек - см. write_settings() в flash.c:
+ *         protocol | can_bitrate | addr_id | volume.
+ * @param  None
+ * @retval Прескелер CAN для сохраненной скорости.
+ */
+static uint16_t read_settings(void) {
+  uint32_t settings = *(volatile uint32_t *)&__SETTINGS_SECTION_START;
+  uint8_t settings_addr = (uint8_t)(settings >> 8);
+  uint8_t bitrate = (uint8_t)(settings >> 16);
+
+  if (settings_addr != 0 && settings_addr <= BOOT_ADDR_ID_LIMIT) {
+    addr_id = settings_addr;
+  }
+
+  if (bitrate < sizeof(can_prescalers) / sizeof(can_prescalers[0])) {
+    return can_prescalers[bitrate];
+  }
+  return BOOT_DEFAULT_PRESCALER;
+}
+
+/**
+ * @brief  Настройка тактирования (как SystemClock_Config() приложения).
+ * @param  None
+ * @retval None
+ */
+static void SystemClock_Config(void) {
+  RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+  RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+  RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+  RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+  RCC_OscInitStruct.HSEPredivValue = RCC_HSE_PREDIV_DIV1;
+  RCC_OscInitStruct.HSIState = RCC_HSI_ON;
+  RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+  RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+  RCC_OscInitStruct.PLL.PLLMUL = SYSCLK_RCC_PLL_MUL;
+  if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+    Error_Handler();
+  }
+
+  RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK |
+                                RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+  RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+  RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+  RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV4;
+  RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV4;
+
+  if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, SYSCLK_FLASH_LATENCY) != HAL_OK) {
+    Error_Handler();
+  }
+}
+
+/**
+ * @brief  Настройка CAN: прием только кадров от ПК (FW_UPDATE_HOST_ID).
+ * @note   Прием опросом FIFO0, прерывания CAN не используются.
+ * @param  prescaler: Прескелер скорости CAN.
+ * @retval None
+ */
+static void CAN_Init(uint16_t prescaler) {
+  CAN_FilterTypeDef filter = {0};
+
+  hcan.Instance = CAN1;
+  hcan.Init.Prescaler = prescaler;
+  hcan.Init.Mode = CAN_MODE_NORMAL;
+  hcan.Init.SyncJumpWidth = CAN_SJW_1TQ;
+  hcan.Init.TimeSeg1 = CAN_TIME_SEG1;
+  hcan.Init.TimeSeg2 = CAN_TIME_SEG2;
+  hcan.Init.TimeTriggeredMode = DISABLE;
+  hcan.Init.AutoBusOff = ENABLE;
+  hcan.Init.AutoWakeUp = DISABLE;
+  hcan.Init.AutoRetransmission = ENABLE;
+  hcan.Init.ReceiveFifoLocked = DISABLE;
+  hcan.Init.TransmitFifoPriority = ENABLE;
+  if (HAL_CAN_Init(&hcan) != HAL_OK) {
+    Error_Handler();
+  }
+
+  filter.FilterBank = 0;
+  filter.FilterMode = CAN_FILTERMODE_IDLIST;
+  filter.FilterScale = CAN_FILTERSCALE_32BIT;
+  filter.FilterIdHigh = FW_UPDATE_HOST_ID << FILTER_11_BIT_ID_OFFSET;
+  filter.FilterMaskIdHigh = FW_UPDATE_HOST_ID << FILTER_11_BIT_ID_OFFSET;
+  filter.FilterFIFOAssignment = CAN_RX_FIFO0;
+  filter.FilterActivation = ENABLE;
+  filter.SlaveStartFilterBank = 14;
+  if (HAL_CAN_ConfigFilter(&hcan, &filter) != HAL_OK) {
+    Error_Handler();
+  }
+
+  HAL_CAN_Start(&hcan);
+}
+
+/**
+ * @brief  Инициализация выводов и тактирования CAN (без прерываний).
+ * @param  canHandle: Указатель на структуру CAN_HandleTypeDef.
+ * @retval None
+ */
+void HAL_CAN_MspInit(CAN_HandleTypeDef *canHandle) {
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  if (canHandle->Instance == CAN1) {
+    __HAL_RCC_CAN1_CLK_ENABLE();
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+
+    /**CAN GPIO Configuration
+     PA11     ------> CAN_RX
+     PA12     ------> CAN_TX
+     */
+    GPIO_InitStruct.Pin = GPIO_PIN_11;
+    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+
+    GPIO_InitStruct.Pin = GPIO_PIN_12;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+  }
+}
+
+/**
+ * @brief  Отправка кадра ПК (ID: FW_UPDATE_NODE_ID_BASE + адрес).
+ * @param  data: Указатель на данные кадра.
+ * @param  len:  Длина данных (DLC).
+ * @retval None
+ */
+static void CAN_SendFrame(const uint8_t *data, uint8_t len) {
+  CAN_TxHeaderTypeDef header = {0};
+  uint32_t tx_mailbox = 0;
+
+  header.StdId = FW_UPDATE_NODE_ID_BASE + addr_id;
+  header.IDE = CAN_ID_STD;
+  header.RTR = CAN_RTR_DATA;
+  header.DLC = len;
+
+  uint32_t start_ms = HAL_GetTick();
+  while (HAL_CAN_GetTxMailboxesFreeLevel(&hcan) == 0) {
+    if (HAL_GetTick() - start_ms >= BOOT_TX_TIMEOUT_MS) {
+      return;
+    }
+  }
+
+  HAL_CAN_AddTxMessage(&hcan, &header, (uint8_t *)data, &tx_mailbox);
+}
+
+/**
+ * @brief  Прием образа по CAN до установки или истечения времени ожидания.
+ * @param  None
+ * @retval None
+ */
+static void receive_image(void) {
+  CAN_RxHeaderTypeDef header;
+  uint8_t data[8];
+  uint32_t last_frame_ms = HAL_GetTick();
+
+  CAN_Init(read_settings());
+  fw_update_init(addr_id, CAN_SendFrame);
+
+  // Сообщаем ПК о запуске загрузчика
+  static const uint8_t ready[] = {ISOTP_PCI_SF | 3, FW_CMD_STATUS,
+                                  FW_STATE_IDLE, FW_RESULT_OK};
+  CAN_SendFrame(ready, sizeof(ready));
+
+  while (fw_update_get_state() != FW_STATE_VERIFIED) {
+    while (HAL_CAN_GetRxFifoFillLevel(&hcan, CAN_RX_FIFO0) > 0) {
+      if (HAL_CAN_GetRxMessage(&hcan, CAN_RX_FIFO0, &header, data) == HAL_OK &&
+          header.IDE == CAN_ID_STD && header.StdId == FW_UPDATE_HOST_ID) {
+        fw_update_process_frame(data, (uint8_t)header.DLC);
+        last_frame_ms = HAL_GetTick();
+      }
+    }
+
+    // Старое приложение не изменяется до проверки нового образа
+    if (HAL_GetTick() - last_frame_ms >= BOOT_IDLE_TIMEOUT_MS &&
+        is_app_valid()) {
+      return;
+    }
+  }
+
+  // Ожидание отправки ответа на FW_CMD_COMMIT перед стиранием APP
+  HAL_Delay(BOOT_TX_TIMEOUT_MS);
+}
+
+/**
+ * @brief  Точка входа загрузчика.
+ * @retval int
+ */
+int main(void) {
+  bool is_update_requested = boot_request == FW_BOOT_REQUEST_MAGIC;
+  boot_request = 0;
+
+  if (!is_update_requested && fw_update_get_pending_image() == NULL &&
+      is_app_valid()) {
+    jump_to_app();
+  }
+
+  HAL_Init();
+  SystemClock_Config();
+
+  if (fw_update_get_pending_image() == NULL) {
+    receive_image();
+  }
+
+  const fw_meta_t *meta = fw_update_get_pending_image();
+  if (meta != NULL) {
+    fw_update_install(meta);
+  }
+
+  NVIC_SystemReset();
+}
+
+/**
+ * @brief  This function is executed in case of error occurrence.
+ * @retval None
+ */
+void Error_Handler(void) {
+  __disable_irq();
+  NVIC_SystemReset();
+}
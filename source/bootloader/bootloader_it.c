@@ -0,0 +1,17 @@
+/**
+ * @file    bootloader_it.c
+ * @brief   Обработчики исключений загрузчика.
+ * @note    Загрузчик работает без прерываний периферии, остальные обработчики
+ *          - Default_Handler из startup_stm32f103cbtx.s.
+ */
+#include "main.h"
+
+/**
+ * @brief This function handles Hard fault interrupt.
+ */
+void HardFault_Handler(void) { NVIC_SystemReset(); }
+
+/**
+ * @brief This function handles System tick timer (HAL_GetTick).
+ */
+void SysTick_Handler(void) { HAL_IncTick(); }
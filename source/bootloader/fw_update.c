@@ -0,0 +1,461 @@
+/**
+ * @file fw_update.c
+ */
+#include "fw_update.h"
+
+#include <stddef.h>
+
+/* Области flash-памяти (из STM32F103CBTX_BOOT.ld) */
+extern uint32_t __APP_START;
+extern uint32_t __DOWNLOAD_START;
+extern uint32_t __DOWNLOAD_SIZE;
+extern uint32_t __META_START;
+
+#define APP_ADDR ((uint32_t)&__APP_START)
+#define DOWNLOAD_ADDR ((uint32_t)&__DOWNLOAD_START)
+#define DOWNLOAD_SIZE ((uint32_t)&__DOWNLOAD_SIZE)
+#define META_ADDR ((uint32_t)&__META_START)
+
+/// Адрес индикатора.
+static uint8_t addr_id = 0;
+
+/// Функция отправки кадра от индикатора.
+static void (*send_frame)(const uint8_t *data, uint8_t len) = NULL;
+
+/// Текущее состояние обновления.
+static fw_state_t state = FW_STATE_IDLE;
+
+/// Размер образа из команды FW_CMD_START.
+static uint32_t image_size = 0;
+
+/// Кол-во байт образа, записанных во flash (всегда четное, кроме конца).
+static uint32_t written = 0;
+
+/// Младший байт полуслова, ожидающий старший байт для записи.
+static uint8_t pending_byte = 0;
+
+/// Флаг наличия pending_byte.
+static bool has_pending_byte = false;
+
+/// Флаг приема блока (после FF, до последнего CF).
+static bool is_block_active = false;
+
+/// Смещение следующего байта текущего блока в образе.
+static uint32_t block_offset = 0;
+
+/// Кол-во оставшихся байт текущего блока.
+static uint32_t block_remaining = 0;
+
+/// Ожидаемый порядковый номер следующего CF.
+static uint8_t next_sn = 0;
+
+/**
+ * @brief  Отправка состояния обновления (FW_CMD_STATUS).
+ * @param  result: Результат последней команды.
+ * @retval None
+ */
+static void send_status(fw_result_t result) {
+  uint8_t data[4] = {ISOTP_PCI_SF | 3, FW_CMD_STATUS, (uint8_t)state,
+                     (uint8_t)result};
+  send_frame(data, sizeof(data));
+}
+
+/**
+ * @brief  Отправка подтверждения блока (FC со смещением).
+ * @param  flow_status: Состояние потока isotp_flow_status_t.
+ * @retval None
+ */
+static void send_flow_control(isotp_flow_status_t flow_status) {
+  uint8_t data[7] = {ISOTP_PCI_FC | flow_status, FW_UPDATE_WINDOW_BLOCKS, 0};
+  fw_update_put_le32(&data[3], written);
+  send_frame(data, sizeof(data));
+}
+
+/**
+ * @brief  Стирание страниц flash-памяти.
+ * @param  addr: Адрес первой страницы.
+ * @param  size: Кол-во байт (округляется до целых страниц).
+ * @retval true, если страницы стерты.
+ */
+static bool erase_pages(uint32_t addr, uint32_t size) {
+  FLASH_EraseInitTypeDef erase_init = {0};
+  uint32_t page_error = 0;
+
+  erase_init.TypeErase = FLASH_TYPEERASE_PAGES;
+  erase_init.PageAddress = addr;
+  erase_init.NbPages = (size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+
+  HAL_FLASH_Unlock();
+  HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase_init, &page_error);
+  HAL_FLASH_Lock();
+
+  return status == HAL_OK;
+}
+
+/**
+ * @brief  Запись полуслова во flash-память (память должна быть разблокирована).
+ * @param  addr: Адрес полуслова.
+ * @param  data: Значение.
+ * @retval true, если значение записано и прочитано обратно.
+ */
+static bool program_half_word(uint32_t addr, uint16_t data) {
+  if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr, data) != HAL_OK) {
+    return false;
+  }
+  return *(volatile uint16_t *)addr == data;
+}
+
+/**
+ * @brief  Запись очередного байта образа в область загрузки.
+ * @note   Байты пишутся парами (полусловами), последний нечетный байт
+ *         дополняется 0xFF.
+ * @param  byte: Значение байта.
+ * @retval true, если байт принят.
+ */
+static bool write_byte(uint8_t byte) {
+  bool is_last_byte = written + 1 == image_size;
+
+  if (!has_pending_byte && !is_last_byte) {
+    pending_byte = byte;
+    has_pending_byte = true;
+    return true;
+  }
+
+  uint16_t half_word = has_pending_byte ? (uint16_t)(pending_byte | byte << 8)
+                                        : (uint16_t)(byte | 0xFF00);
+
+  HAL_FLASH_Unlock();
+  bool is_ok = program_half_word(DOWNLOAD_ADDR + written, half_word);
+  HAL_FLASH_Lock();
+
+  if (is_ok) {
+    written += has_pending_byte ? 2 : 1;
+    has_pending_byte = false;
+  }
+  return is_ok;
+}
+
+/**
+ * @brief  Сброс приема текущего блока (пропуск кадра).
+ * @note   Непарный байт отбрасывается: ПК повторит передачу со смещения
+ *         written.
+ * @param  None
+ * @retval None
+ */
+static void drop_block(void) {
+  is_block_active = false;
+  has_pending_byte = false;
+  send_flow_control(ISOTP_FS_RETRY);
+}
+
+/**
+ * @brief  Прием байт блока.
+ * @note   Байты до уже записанного смещения пропускаются (повтор для других
+ *         индикаторов), разрыв после него сбрасывает блок.
+ * @param  data: Указатель на байты блока.
+ * @param  len:  Кол-во байт в кадре.
+ * @retval None
+ */
+static void receive_block_data(const uint8_t *data, uint8_t len) {
+  if (len > block_remaining) {
+    len = (uint8_t)block_remaining;
+  }
+
+  for (uint8_t i = 0; i < len; i++, block_offset++) {
+    uint32_t expected = written + (has_pending_byte ? 1 : 0);
+
+    if (block_offset < expected || block_offset >= image_size) {
+      continue;
+    }
+
+    if (block_offset > expected) {
+      drop_block();
+      return;
+    }
+
+    if (!write_byte(data[i])) {
+      state = FW_STATE_ERROR;
+      is_block_active = false;
+      send_flow_control(ISOTP_FS_OVFLW);
+      return;
+    }
+  }
+
+  block_remaining -= len;
+  if (block_remaining == 0) {
+    is_block_active = false;
+    send_flow_control(ISOTP_FS_CTS);
+  }
+}
+
+/**
+ * @brief  Обработка First Frame: начало блока.
+ * @param  data: Указатель на данные кадра.
+ * @param  len:  Длина данных (DLC).
+ * @retval None
+ */
+static void process_first_frame(const uint8_t *data, uint8_t len) {
+  uint32_t msg_len = ((uint32_t)(data[0] & ~ISOTP_PCI_MASK) << 8) | data[1];
+
+  if (len < 8 || msg_len <= FW_UPDATE_BLOCK_HEADER_SIZE ||
+      msg_len > FW_UPDATE_BLOCK_HEADER_SIZE + FW_UPDATE_BLOCK_SIZE) {
+    return;
+  }
+
+  if (state == FW_STATE_READY) {
+    state = FW_STATE_RECEIVING;
+  }
+
+  block_offset = fw_update_get_le32(&data[2]);
+  block_remaining = msg_len - FW_UPDATE_BLOCK_HEADER_SIZE;
+  next_sn = 1;
+  is_block_active = true;
+
+  // Блок после пропуска данных: запрос повтора с written
+  if (block_offset > written) {
+    drop_block();
+    return;
+  }
+
+  has_pending_byte = false; // Непарный байт будет принят повторно из блока
+  receive_block_data(&data[2 + FW_UPDATE_BLOCK_HEADER_SIZE],
+                     ISOTP_FF_DATA_SIZE - FW_UPDATE_BLOCK_HEADER_SIZE);
+}
+
+/**
+ * @brief  Обработка Consecutive Frame: продолжение блока.
+ * @param  data: Указатель на данные кадра.
+ * @param  len:  Длина данных (DLC).
+ * @retval None
+ */
+static void process_consecutive_frame(const uint8_t *data, uint8_t len) {
+  if (!is_block_active) {
+    return;
+  }
+
+  if ((data[0] & ISOTP_SN_MASK) != next_sn) {
+    drop_block();
+    return;
+  }
+
+  next_sn = (next_sn + 1) & ISOTP_SN_MASK;
+  receive_block_data(&data[1], len - 1);
+}
+
+/**
+ * @brief  Команда FW_CMD_START: стирание области загрузки под образ.
+ * @note   Повторная команда с тем же размером не стирает уже принятые данные
+ *         (ответ для индикаторов, не получивших предыдущий ответ).
+ * @param  size: Размер образа.
+ * @retval None
+ */
+static void start_update(uint32_t size) {
+  if ((state == FW_STATE_READY || state == FW_STATE_RECEIVING) &&
+      size == image_size) {
+    send_status(FW_RESULT_OK);
+    return;
+  }
+
+  if (size == 0 || size > DOWNLOAD_SIZE) {
+    state = FW_STATE_ERROR;
+    send_status(FW_RESULT_BAD_SIZE);
+    return;
+  }
+
+  image_size = size;
+  written = 0;
+  has_pending_byte = false;
+  is_block_active = false;
+
+  if (!erase_pages(META_ADDR, sizeof(fw_meta_t)) ||
+      !erase_pages(DOWNLOAD_ADDR, size)) {
+    state = FW_STATE_ERROR;
+    send_status(FW_RESULT_FLASH_ERROR);
+    return;
+  }
+
+  state = FW_STATE_READY;
+  send_status(FW_RESULT_OK);
+}
+
+/**
+ * @brief  Команда FW_CMD_COMMIT: проверка CRC и запись описания образа.
+ * @param  crc: CRC-32 образа, рассчитанная на ПК.
+ * @retval None
+ */
+static void commit_update(uint32_t crc) {
+  if (state == FW_STATE_VERIFIED) {
+    send_status(FW_RESULT_OK);
+    return;
+  }
+
+  if (state != FW_STATE_RECEIVING) {
+    send_status(FW_RESULT_BAD_STATE);
+    return;
+  }
+
+  if (written != image_size) {
+    send_status(FW_RESULT_INCOMPLETE);
+    send_flow_control(ISOTP_FS_RETRY);
+    return;
+  }
+
+  if (fw_update_crc32(0, (const uint8_t *)DOWNLOAD_ADDR, image_size) != crc) {
+    state = FW_STATE_ERROR;
+    send_status(FW_RESULT_CRC_MISMATCH);
+    return;
+  }
+
+  fw_meta_t meta = {FW_META_MAGIC, image_size, crc, ~FW_META_MAGIC};
+  const uint16_t *src = (const uint16_t *)&meta;
+  bool is_ok = true;
+
+  HAL_FLASH_Unlock();
+  for (uint32_t i = 0; i < sizeof(meta) / sizeof(uint16_t) && is_ok; i++) {
+    is_ok = program_half_word(META_ADDR + i * sizeof(uint16_t), src[i]);
+  }
+  HAL_FLASH_Lock();
+
+  state = is_ok ? FW_STATE_VERIFIED : FW_STATE_ERROR;
+  send_status(is_ok ? FW_RESULT_OK : FW_RESULT_FLASH_ERROR);
+}
+
+/**
+ * @brief  Инициализация приема образа.
+ * @param  node_addr: Адрес индикатора (для команд и ответов).
+ * @param  send:      Функция отправки кадра от индикатора (ID - по адресу).
+ * @retval None
+ */
+void fw_update_init(uint8_t node_addr,
+                    void (*send)(const uint8_t *data, uint8_t len)) {
+  addr_id = node_addr;
+  send_frame = send;
+  state = FW_STATE_IDLE;
+}
+
+/**
+ * @brief  Обработка кадра от ПК (FW_UPDATE_HOST_ID).
+ * @param  data: Указатель на данные кадра.
+ * @param  len:  Длина данных (DLC).
+ * @retval None
+ */
+void fw_update_process_frame(const uint8_t *data, uint8_t len) {
+  if (len == 0) {
+    return;
+  }
+
+  switch (data[0] & ISOTP_PCI_MASK) {
+  case ISOTP_PCI_FF:
+    if (state == FW_STATE_READY || state == FW_STATE_RECEIVING) {
+      process_first_frame(data, len);
+    }
+    return;
+
+  case ISOTP_PCI_CF:
+    process_consecutive_frame(data, len);
+    return;
+
+  case ISOTP_PCI_SF:
+    break;
+
+  default:
+    return;
+  }
+
+  uint8_t sf_len = data[0] & ISOTP_SF_LEN_MASK;
+  if (sf_len < 2 || sf_len >= len) {
+    return;
+  }
+
+  // Команды адресованы всем индикаторам или одному индикатору
+  if (data[2] != FW_UPDATE_BROADCAST_ADDR && data[2] != addr_id) {
+    return;
+  }
+
+  switch (data[1]) {
+  case FW_CMD_ENTER:
+    send_status(FW_RESULT_OK); // Загрузчик уже запущен
+    break;
+
+  case FW_CMD_START:
+    if (sf_len >= 6) {
+      start_update(fw_update_get_le32(&data[3]));
+    }
+    break;
+
+  case FW_CMD_COMMIT:
+    if (sf_len >= 6) {
+      commit_update(fw_update_get_le32(&data[3]));
+    }
+    break;
+
+  case FW_CMD_ABORT:
+    state = FW_STATE_IDLE;
+    image_size = 0;
+    is_block_active = false;
+    send_status(FW_RESULT_OK);
+    break;
+
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief  Получение текущего состояния обновления.
+ * @param  None
+ * @retval Состояние fw_state_t.
+ */
+fw_state_t fw_update_get_state(void) { return state; }
+
+/**
+ * @brief  Получение описания проверенного образа.
+ * @param  None
+ * @retval Указатель на описание в странице META, NULL - образа нет.
+ */
+const fw_meta_t *fw_update_get_pending_image(void) {
+  const fw_meta_t *meta = (const fw_meta_t *)META_ADDR;
+
+  bool is_valid = meta->magic == FW_META_MAGIC &&
+                  meta->magic_inv == ~FW_META_MAGIC && meta->size != 0 &&
+                  meta->size <= DOWNLOAD_SIZE;
+
+  return is_valid ? meta : NULL;
+}
+
+/**
+ * @brief  Установка проверенного образа: копирование в APP и проверка CRC.
+ * @note   Страница META стирается только после успешной проверки APP, поэтому
+ *         при пропадании питания копирование повторится при следующем
+ *         запуске.
+ * @param  meta: Указатель на описание образа.
+ * @retval true, если образ установлен.
+ */
+bool fw_update_install(const fw_meta_t *meta) {
+  uint32_t size = meta->size;
+  uint32_t crc = meta->crc;
+
+  if (fw_update_crc32(0, (const uint8_t *)DOWNLOAD_ADDR, size) != crc) {
+    erase_pages(META_ADDR, sizeof(fw_meta_t)); // Образ поврежден
+    return false;
+  }
+
+  if (!erase_pages(APP_ADDR, size)) {
+    return false;
+  }
+
+  const uint16_t *src = (const uint16_t *)DOWNLOAD_ADDR;
+  bool is_ok = true;
+
+  HAL_FLASH_Unlock();
+  for (uint32_t i = 0; i < (size + 1) / sizeof(uint16_t) && is_ok; i++) {
+    is_ok = program_half_word(APP_ADDR + i * sizeof(uint16_t), src[i]);
+  }
+  HAL_FLASH_Lock();
+
+  if (!is_ok || fw_update_crc32(0, (const uint8_t *)APP_ADDR, size) != crc) {
+    return false;
+  }
+
+  return erase_pages(META_ADDR, sizeof(fw_meta_t));
+}
@@ -0,0 +1,69 @@
+/**
+ * @file    fw_update.h
+ * @brief   Этот файл содержит прототипы функций для файла fw_update.c
+ */
+#ifndef __FW_UPDATE_H__
+#define __FW_UPDATE_H__
+
+#include "fw_update_protocol.h"
+#include "main.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FW_META_MAGIC                                                          \
+  0x5AA5C3E1U ///< Признак проверенного образа в области загрузки
+
+/**
+ * Описание проверенного образа (страница META): пока страница записана,
+ * загрузчик при каждом запуске копирует образ из области загрузки в APP.
+ */
+typedef struct {
+  uint32_t magic;     // FW_META_MAGIC
+  uint32_t size;      // Размер образа в байтах
+  uint32_t crc;       // CRC-32 образа
+  uint32_t magic_inv; // ~FW_META_MAGIC (защита от частичной записи)
+} fw_meta_t;
+
+/**
+ * @brief  Инициализация приема образа.
+ * @param  node_addr: Адрес индикатора (для команд и ответов).
+ * @param  send:      Функция отправки кадра от индикатора (ID - по адресу).
+ * @retval None
+ */
+void fw_update_init(uint8_t node_addr,
+                    void (*send)(const uint8_t *data, uint8_t len));
+
+/**
+ * @brief  Обработка кадра от ПК (FW_UPDATE_HOST_ID).
+ * @param  data: Указатель на данные кадра.
+ * @param  len:  Длина данных (DLC).
+ * @retval None
+ */
+void fw_update_process_frame(const uint8_t *data, uint8_t len);
+
+/**
+ * @brief  Получение текущего состояния обновления.
+ * @param  None
+ * @retval Состояние fw_state_t.
+ */
+fw_state_t fw_update_get_state(void);
+
+/**
+ * @brief  Получение описания проверенного образа.
+ * @param  None
+ * @retval Указатель на описание в странице META, NULL - образа нет.
+ */
+const fw_meta_t *fw_update_get_pending_image(void);
+
+/**
+ * @brief  Установка проверенного образа: копирование в APP и проверка CRC.
+ * @note   Страница META стирается только после успешной проверки APP, поэтому
+ *         при пропадании питания копирование повторится при следующем
+ *         запуске.
+ * @param  meta: Указатель на описание образа.
+ * @retval true, если образ установлен.
+ */
+bool fw_update_install(const fw_meta_t *meta);
+
+#endif /* __FW_UPDATE_H__ */
@@ -0,0 +1,184 @@
+/**
+ * @file    fw_update_protocol.h
+ * @brief   Протокол обновления ПО по CAN (общий для загрузчика, приложения и
+ *          программы на ПК).
+ * @note    Кадры узкого формата ISO-TP (ISO 15765-2): SF, FF, CF, FC.
+ *          Образ передается блоками, каждый блок - одно сообщение ISO-TP
+ *          (FF + CF), которое начинается со смещения блока в образе.
+ */
+#ifndef __FW_UPDATE_PROTOCOL_H__
+#define __FW_UPDATE_PROTOCOL_H__
+
+#include <stdint.h>
+
+#define FW_UPDATE_HOST_ID                                                      \
+  0x7F0 ///< ID кадров от ПК (широковещательные, для всех индикаторов)
+#define FW_UPDATE_NODE_ID_BASE                                                 \
+  0x700 ///< ID кадров от индикатора: FW_UPDATE_NODE_ID_BASE + адрес
+#define FW_UPDATE_BROADCAST_ADDR                                               \
+  0 ///< Адрес назначения команды "все индикаторы"
+
+/* Тип кадра ISO-TP (PCI, старший полубайт 1-го байта) */
+#define ISOTP_PCI_MASK 0xF0 ///< Маска типа кадра
+#define ISOTP_PCI_SF 0x00   ///< Single Frame: [0x0L, данные (L <= 7)]
+#define ISOTP_PCI_FF 0x10   ///< First Frame: [0x1L, L, данные (L - 12 бит)]
+#define ISOTP_PCI_CF 0x20   ///< Consecutive Frame: [0x2N, 7 байт данных]
+#define ISOTP_PCI_FC 0x30   ///< Flow Control: [0x3S, BS, STmin, ...]
+#define ISOTP_SF_LEN_MASK 0x0F ///< Маска длины данных SF
+#define ISOTP_SN_MASK 0x0F     ///< Маска порядкового номера CF
+#define ISOTP_FF_DATA_SIZE 6   ///< Кол-во байт данных в FF
+#define ISOTP_CF_DATA_SIZE 7   ///< Кол-во байт данных в CF
+
+/**
+ * Состояние потока в кадре FC (младший полубайт 1-го байта).
+ * @note FC отправляется индикатором после каждого принятого блока и содержит
+ *       смещение следующего ожидаемого байта образа (байты 3..6, LE).
+ */
+typedef enum {
+  ISOTP_FS_CTS = 0,   // Блок принят, можно продолжать
+  ISOTP_FS_RETRY = 1, // Пропуск данных: повторить со смещения (вместо WAIT)
+  ISOTP_FS_OVFLW = 2  // Ошибка записи, передача для индикатора прекращена
+} isotp_flow_status_t;
+
+#define FW_UPDATE_BLOCK_SIZE                                                   \
+  1024 ///< Кол-во байт образа в одном блоке (сообщении ISO-TP)
+#define FW_UPDATE_BLOCK_HEADER_SIZE                                            \
+  4 ///< Смещение блока в образе (LE) в начале сообщения
+#define FW_UPDATE_WINDOW_BLOCKS                                                \
+  4 ///< Окно: кол-во блоков, отправляемых без подтверждения (BS в FC)
+
+/**
+ * Команды (1-й байт данных SF).
+ * @note Команды FW_CMD_LABEL_* обрабатывает приложение (надписи этажей), ответ
+ *       - FW_CMD_STATUS с состоянием FW_STATE_IDLE. Команду FW_CMD_DIAG
+ *       обрабатывает приложение, ответ - FW_CMD_DIAG_INFO (одно поле
+ *       статистики fw_diag_record_t) или FW_CMD_STATUS с результатом
+ *       FW_RESULT_BAD_DIAG. Команду FW_CMD_RESET_CAUSE обрабатывает
+ *       приложение, ответ - FW_CMD_RESET_INFO (маска задач, не отметившихся
+ *       перед сбросом IWDG, бит - task_id_t).
+ */
+typedef enum {
+  FW_CMD_ENTER = 0x01,  // ПК: [cmd, адрес] - перезапуск в загрузчик
+  FW_CMD_START = 0x02,  // ПК: [cmd, адрес, размер (LE32)] - подготовка
+  FW_CMD_COMMIT = 0x03, // ПК: [cmd, адрес, CRC32 (LE32)] - проверка и замена
+  FW_CMD_ABORT = 0x04,  // ПК: [cmd, адрес] - отмена обновления
+
+  FW_CMD_LABEL_SET = 0x05,    // ПК: [cmd, адрес, код этажа, MSB, LSB]
+  FW_CMD_LABEL_COMMIT = 0x06, // ПК: [cmd, адрес] - запись надписей во flash
+  FW_CMD_LABEL_CLEAR = 0x07,  // ПК: [cmd, адрес] - стирание надписей
+  FW_CMD_DIAG = 0x08,         // ПК: [cmd, адрес, запись, элемент << 4 | поле]
+  FW_CMD_RESET_CAUSE = 0x09,  // ПК: [cmd, адрес] - причина перезапуска
+
+  FW_CMD_STATUS = 0x80,     // Индикатор: [cmd, fw_state_t, fw_result_t]
+  FW_CMD_DIAG_INFO = 0x81,  // Индикатор: [cmd, запись, элемент << 4 | поле,
+                            //  значение (LE32)]
+  FW_CMD_RESET_INFO = 0x82  // Индикатор: [cmd, fw_reset_cause_t, маска задач,
+                            //  кол-во сбросов IWDG (LE16)]
+} fw_cmd_t;
+
+/**
+ * Состояние обновления на индикаторе.
+ */
+typedef enum {
+  FW_STATE_IDLE = 0,      // Ожидание команды FW_CMD_START
+  FW_STATE_READY = 1,     // Область загрузки стерта, ожидание данных
+  FW_STATE_RECEIVING = 2, // Прием блоков
+  FW_STATE_VERIFIED = 3,  // CRC совпала, образ будет установлен
+  FW_STATE_ERROR = 4      // Ошибка, требуется новая команда FW_CMD_START
+} fw_state_t;
+
+/**
+ * Результат последней команды на индикаторе.
+ */
+typedef enum {
+  FW_RESULT_OK = 0,
+  FW_RESULT_BAD_SIZE = 1,     // Размер образа 0 или больше области загрузки
+  FW_RESULT_FLASH_ERROR = 2,  // Ошибка стирания/записи flash
+  FW_RESULT_INCOMPLETE = 3,   // FW_CMD_COMMIT до приема всего образа
+  FW_RESULT_CRC_MISMATCH = 4, // CRC принятого образа не совпала
+  FW_RESULT_BAD_STATE = 5,    // Команда не допустима в текущем состоянии
+  FW_RESULT_BAD_LABEL = 6,    // Код этажа или символ надписи не допустим
+  FW_RESULT_BAD_DIAG = 7      // Нет записи, элемента или поля статистики
+} fw_result_t;
+
+/**
+ * Записи статистики приложения (команда FW_CMD_DIAG). Порядок полей записи -
+ * порядок полей структуры статистики (см. diagnostics.h).
+ */
+typedef enum {
+  FW_DIAG_TASK = 0,         // Задача планировщика (элемент - task_id_t)
+  FW_DIAG_DISPLAY_SYNC = 1, // Синхронизация отображения
+  FW_DIAG_LINK = 2,         // Монитор связи
+  FW_DIAG_CAN = 3,          // Восстановление CAN и время приема кадров
+  FW_DIAG_PROTOCOL = 4,     // Время обработки кадров протокола
+  FW_DIAG_ISR = 5,          // Максимальное время прерывания (isr_id_t)
+  FW_DIAG_STARTUP = 6,      // Запуск индикатора
+  FW_DIAG_RECORDS_COUNT
+} fw_diag_record_t;
+
+#define FW_DIAG_ITEM_SHIFT 4    ///< Смещение номера элемента в 4-м байте
+#define FW_DIAG_FIELD_MASK 0x0F ///< Маска номера поля в 4-м байте
+
+/**
+ * Причина последнего перезапуска индикатора (флаги RCC_CSR).
+ */
+typedef enum {
+  FW_RESET_UNKNOWN = 0,  // Флаги не установлены
+  FW_RESET_POWER = 1,    // Включение питания (POR/PDR)
+  FW_RESET_PIN = 2,      // Вывод NRST
+  FW_RESET_SOFTWARE = 3, // NVIC_SystemReset() (загрузчик, обновление)
+  FW_RESET_WATCHDOG = 4, // IWDG: задача не отметилась (зависание)
+  FW_RESET_WWDG = 5,     // Оконный сторожевой таймер
+  FW_RESET_LOW_POWER = 6 // Ошибка входа в режим пониженного потребления
+} fw_reset_cause_t;
+
+#define FW_BOOT_REQUEST_MAGIC                                                  \
+  0xB007C0DEUL ///< Запрос загрузчика (в .noinit RAM перед перезапуском)
+
+/**
+ * @brief  Расчет CRC-32 (IEEE 802.3, как в zlib) полубайтовой таблицей.
+ * @param  crc:  Предыдущее значение (0 для начала расчета).
+ * @param  data: Указатель на данные.
+ * @param  len:  Кол-во байт данных.
+ * @retval Значение CRC-32.
+ */
+static inline uint32_t fw_update_crc32(uint32_t crc, const uint8_t *data,
+                                       uint32_t len) {
+  static const uint32_t table[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+      0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+
+  crc = ~crc;
+  for (uint32_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+/**
+ * @brief  Чтение 32-битного значения (little-endian) из кадра.
+ * @param  data: Указатель на первый байт.
+ * @retval Значение.
+ */
+static inline uint32_t fw_update_get_le32(const uint8_t *data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+         ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+/**
+ * @brief  Запись 32-битного значения (little-endian) в кадр.
+ * @param  data:  Указатель на первый байт.
+ * @param  value: Значение.
+ * @retval None
+ */
+static inline void fw_update_put_le32(uint8_t *data, uint32_t value) {
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+  data[2] = (uint8_t)(value >> 16);
+  data[3] = (uint8_t)(value >> 24);
+}
+
+#endif /* __FW_UPDATE_PROTOCOL_H__ */
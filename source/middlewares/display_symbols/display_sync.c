@@ -0,0 +1,165 @@
+/**
+ * @file display_sync.c
+ */
+#include "display_sync.h"
+
+#include "tim.h"
+#include "timebase.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+/// Отображаемая строка (применяется на границе строки развертки).
+static char shown_string[DISPLAY_SYNC_STRING_SIZE + 1] = "c--";
+
+/// Строка последнего кадра, ожидающая применения.
+static char pending_string[DISPLAY_SYNC_STRING_SIZE + 1] = "";
+
+/// Флаг ожидающего кадра (строка pending_string еще не применена).
+static volatile bool is_pending = false;
+
+/// Время в мкс от границы строки перед приемом кадра до применения строки.
+static uint32_t apply_at_us = 0;
+
+/// Время в мкс от границы строки перед приемом кадра до текущей границы.
+static uint32_t elapsed_us = 0;
+
+/// Время приема первого кадра, ожидающего применения (timebase_now_us()).
+static uint32_t pending_rx_us = 0;
+
+/// Статистика синхронизации отображения.
+static volatile display_sync_stats_t sync_stats = {0, 0, 0, 0, 0, 0, 0};
+
+/**
+ * @brief  Период строки развертки в мкс (период TIM4).
+ * @param  None
+ * @retval Период в мкс.
+ */
+static uint16_t row_period_us() {
+  return __HAL_TIM_GET_AUTORELOAD(&htim4) + 1;
+}
+
+/**
+ * @brief  Подстройка фазы строки развертки к моменту приема кадра.
+ * @note   Граница строки сдвигается к моменту приема на 1/DISPLAY_SYNC_SLEW_DIV
+ *         ошибки (не больше DISPLAY_SYNC_MAX_SLEW_US): счетчик TIM4 уменьшается
+ *         (строка длиннее) или увеличивается (строка короче) в пределах
+ *         периода. Все индикаторы шины подстраиваются к одному моменту,
+ *         поэтому разность их фаз уменьшается с каждым кадром.
+ * @param  phase_us:  Время от границы строки до приема кадра в мкс.
+ * @param  period_us: Период строки в мкс.
+ * @retval None
+ */
+static void align_row_phase(uint16_t phase_us, uint16_t period_us) {
+  bool is_boundary_before = phase_us < period_us / 2;
+  uint16_t error_us = is_boundary_before ? phase_us : period_us - phase_us;
+  uint16_t slew_us = error_us / DISPLAY_SYNC_SLEW_DIV;
+
+  if (slew_us > DISPLAY_SYNC_MAX_SLEW_US) {
+    slew_us = DISPLAY_SYNC_MAX_SLEW_US;
+  }
+
+  if (is_boundary_before) {
+    __HAL_TIM_SET_COUNTER(&htim4, phase_us - slew_us);
+  } else {
+    __HAL_TIM_SET_COUNTER(&htim4, phase_us + slew_us);
+  }
+  sync_stats.phase_error_us = error_us;
+}
+
+/**
+ * @brief  Сброс синхронизации: отображаемая строка - string, ожидающего
+ *         кадра нет.
+ * @param  string: Указатель на строку (DISPLAY_SYNC_STRING_SIZE символов).
+ * @retval None
+ */
+void display_sync_reset(const char *string) {
+  __disable_irq();
+  memcpy(shown_string, string, DISPLAY_SYNC_STRING_SIZE);
+  is_pending = false;
+  sync_stats = (display_sync_stats_t){0, 0, 0, 0, 0, 0, 0};
+  __enable_irq();
+}
+
+/**
+ * @brief  Регистрация кадра протокола (вызывается из прерывания приема после
+ *         декодера).
+ * @note   1. Фаза строки развертки подстраивается к моменту приема
+ *            (align_row_phase());
+ *         2. Строка кадра копируется в pending_string. Момент применения
+ *            назначается первым кадром: DISPLAY_SYNC_DELAY_US плюс полпериода
+ *            строки от приема, т.е. посередине между границами строк
+ *            (границы индикаторов с близкой фазой не оказываются по разные
+ *            стороны от момента применения). Следующие кадры до применения
+ *            только обновляют строку, чтобы частые кадры не откладывали
+ *            применение.
+ * @param  string: Указатель на строку, записанную декодером (matrix_string).
+ * @retval None
+ */
+void display_sync_frame_received(const char *string) {
+  uint16_t phase_us = __HAL_TIM_GET_COUNTER(&htim4);
+  uint16_t period_us = row_period_us();
+
+  align_row_phase(phase_us, period_us);
+
+  memcpy(pending_string, string, DISPLAY_SYNC_STRING_SIZE);
+  if (!is_pending) {
+    apply_at_us = phase_us + DISPLAY_SYNC_DELAY_US + period_us / 2;
+    elapsed_us = 0;
+    pending_rx_us = timebase_now_us();
+    is_pending = true;
+  }
+  if (sync_stats.frames == 0) {
+    sync_stats.first_rx_us = pending_rx_us;
+  }
+  sync_stats.frames++;
+}
+
+/**
+ * @brief  Граница строки развертки (вызывается каждый период TIM4).
+ * @note   Строка ожидающего кадра применяется на первой границе строки не
+ *         раньше DISPLAY_SYNC_DELAY_US от приема кадра. После подстройки фазы
+ *         границы строк индикаторов группы совпадают, поэтому все индикаторы
+ *         меняют этаж в пределах одного периода строки.
+ * @param  None
+ * @retval None
+ */
+void display_sync_row_elapsed(void) {
+  if (!is_pending) {
+    return;
+  }
+
+  elapsed_us += row_period_us();
+  if (elapsed_us >= apply_at_us) {
+    memcpy(shown_string, pending_string, DISPLAY_SYNC_STRING_SIZE);
+    is_pending = false;
+    if (sync_stats.updates == 0) {
+      sync_stats.first_update_us = timebase_now_us();
+    }
+    sync_stats.updates++;
+
+    // Задержка отображения кадра (шкала времени общая с кадрами и задачами)
+    sync_stats.latency_us = timebase_elapsed_us(pending_rx_us);
+    if (sync_stats.latency_us > sync_stats.max_latency_us) {
+      sync_stats.max_latency_us = sync_stats.latency_us;
+    }
+  }
+}
+
+/**
+ * @brief  Получение строки для отображения (применена на границе строки).
+ * @param  None
+ * @retval Указатель на строку.
+ */
+char *display_sync_string(void) { return shown_string; }
+
+/**
+ * @brief  Получение статистики синхронизации отображения.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void display_sync_get_stats(display_sync_stats_t *stats) {
+  __disable_irq();
+  *stats = *(display_sync_stats_t *)&sync_stats;
+  __enable_irq();
+}
@@ -0,0 +1,75 @@
+/**
+ * @file    display_sync.h
+ * @brief   Этот файл содержит прототипы функций для файла display_sync.c
+ */
+#ifndef __DISPLAY_SYNC_H__
+#define __DISPLAY_SYNC_H__
+
+#include <stdint.h>
+
+#define DISPLAY_SYNC_STRING_SIZE 3 ///< Кол-во символов строки (matrix_string)
+#define DISPLAY_SYNC_DELAY_US                                                  \
+  2000 ///< Задержка применения кадра от момента приема (больше разброса
+       ///< времени декодирования на индикаторах группы)
+#define DISPLAY_SYNC_SLEW_DIV                                                  \
+  4 ///< Доля ошибки фазы строки, устраняемая за один кадр (1/4)
+#define DISPLAY_SYNC_MAX_SLEW_US                                               \
+  50 ///< Максимальная подстройка фазы строки за один кадр в мкс (яркость
+     ///< строки изменяется не больше чем на 5%)
+
+/**
+ * Статистика синхронизации отображения.
+ */
+typedef struct {
+  uint32_t frames;         // Кол-во кадров, принятых для синхронизации
+  uint32_t updates;        // Кол-во применений строки на границе строки
+  uint16_t phase_error_us; // Ошибка фазы строки в последнем кадре (мкс)
+  uint32_t latency_us;     // От приема кадра до применения строки (мкс)
+  uint32_t max_latency_us; // Максимальное время от приема до применения
+  uint32_t first_rx_us;     // Прием первого кадра (timebase_now_us())
+  uint32_t first_update_us; // Применение строки первого кадра
+} display_sync_stats_t;
+
+/**
+ * @brief  Сброс синхронизации: отображаемая строка - string, ожидающего
+ *         кадра нет.
+ * @param  string: Указатель на строку (DISPLAY_SYNC_STRING_SIZE символов).
+ * @retval None
+ */
+void display_sync_reset(const char *string);
+
+/**
+ * @brief  Регистрация кадра протокола (вызывается из прерывания приема после
+ *         декодера).
+ * @note   Момент приема кадра общий для всех индикаторов шины: по нему
+ *         подстраивается фаза строки развертки (TIM4) и назначается граница
+ *         строки, на которой строка применяется.
+ * @param  string: Указатель на строку, записанную декодером (matrix_string).
+ * @retval None
+ */
+void display_sync_frame_received(const char *string);
+
+/**
+ * @brief  Граница строки развертки (вызывается каждый период TIM4).
+ * @note   Строка ожидающего кадра применяется на первой границе строки не
+ *         раньше DISPLAY_SYNC_DELAY_US от приема кадра.
+ * @param  None
+ * @retval None
+ */
+void display_sync_row_elapsed(void);
+
+/**
+ * @brief  Получение строки для отображения (применена на границе строки).
+ * @param  None
+ * @retval Указатель на строку.
+ */
+char *display_sync_string(void);
+
+/**
+ * @brief  Получение статистики синхронизации отображения.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void display_sync_get_stats(display_sync_stats_t *stats);
+
+#endif /*__DISPLAY_SYNC_H__ */
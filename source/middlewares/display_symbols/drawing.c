@@ -5,6 +5,7 @@
 
 #include "dot.h"
 #include "font.h"
+#include "timer_wheel.h"
 
 #include <stdbool.h>
 #include <string.h>
@@ -12,6 +13,9 @@
 #define BINARY_SYMBOL_CODE_SIZE                                                \
   6 ///< Количество битов в строке кода символа в font.c.
 
+#define TIME_DISPLAY_STRING_DURING_MS                                          \
+  2000 ///< Время в мс, в течение которого отображается строка
+
 /**
  * @brief Преобразование числа в символ (для этажей 0..9).
  *
@@ -62,62 +66,62 @@ void set_direction_symbol(char *matrix_string, directionType direction) {
 /**
  * @brief  Установка символов для этажей в matrix_string по индексам MSB и LSB.
  * @param  matrix_string:                Указатель на строку для отображения.
- * @param  floor:                        Этаж (код).
+ * @param  floor:                        Этаж (номер).
  * @param  max_positive_number_location: Максимвльное значение для
- *                                       положительного номера этажа в
- *                                       протоколе.
- * @param  code_location_symbols:        Указатель на буфер с символами для
- *                                       спец. режимов/символов протокола.
- * @param  spec_symbols_buff_size:       Кол-во элементов в буфере
- *                                       special_symbols_code_location.
+ *                                       положительного номера этажа.
  * @retval None
  */
 void set_floor_symbols(char *matrix_string, uint16_t floor,
-                       uint8_t max_positive_number_location,
-                       const code_location_symbols_t *code_location_symbols,
-                       uint8_t spec_symbols_buff_size) {
+                       uint8_t max_positive_number_location) {
   if (floor <= 9) {
     matrix_string[MSB] = convert_int_to_char(floor % 10);
     matrix_string[LSB] = 'c';
   } else if (floor <= max_positive_number_location) {
     matrix_string[MSB] = convert_int_to_char(floor / 10);
     matrix_string[LSB] = convert_int_to_char(floor % 10);
-  } else {
-    // Спец. символы
-    for (uint8_t ind = 0; ind < spec_symbols_buff_size; ind++) {
-      if (code_location_symbols[ind].code_location == floor) {
-        matrix_string[MSB] = code_location_symbols[ind].symbols[0];
-        matrix_string[LSB] = strlen(code_location_symbols[ind].symbols) == 1
-                                 ? 'c'
-                                 : code_location_symbols[ind].symbols[1];
-      }
-    }
   }
 }
 
 /**
- * @brief  Установка строки для отображения.
- * @param  matrix_string:                 Указатель на строку.
- * @param  drawing_data:                  Указатель на структуру с этажом и
- *                                        направлением движения.
- * @param  max_positive_number_location:  Максимвльное значение для
- *                                        положительного номера этажа в
- *                                        протоколе.
- * @param  special_symbols_code_location: Указатель на буфер с символами для
- *                                        спец. режимов/символов протокола.
- * @param  spec_symbols_buff_size:        Кол-во элементов в буфере
- *                                        special_symbols_code_location.
+ * @brief  Установка строки для отображения (номер этажа).
+ * @param  matrix_string:                Указатель на строку.
+ * @param  drawing_data:                 Указатель на структуру с этажом и
+ *                                       направлением движения.
+ * @param  max_positive_number_location: Максимвльное значение для
+ *                                       положительного номера этажа.
  * @retval None
  */
-void setting_symbols(
-    char *matrix_string, const drawing_data_t *const drawing_data,
-    uint8_t max_positive_number_location,
-    const code_location_symbols_t *special_symbols_code_location,
-    uint8_t spec_symbols_buff_size) {
+void setting_symbols(char *matrix_string,
+                     const drawing_data_t *const drawing_data,
+                     uint8_t max_positive_number_location) {
   set_direction_symbol(matrix_string, drawing_data->direction);
   set_floor_symbols(matrix_string, drawing_data->floor,
-                    max_positive_number_location, special_symbols_code_location,
-                    spec_symbols_buff_size);
+                    max_positive_number_location);
+}
+
+/**
+ * @brief  Установка строки для отображения по таблице протокола.
+ * @note   Символы этажа - одно чтение из таблицы по коду этажа.
+ * @param  matrix_string: Указатель на строку.
+ * @param  drawing_data:  Указатель на структуру с этажом и направлением
+ *                        движения.
+ * @param  floor_table:   Таблица символов протокола (FLOOR_TABLE_64).
+ * @retval None
+ */
+void setting_symbols_from_table(char *matrix_string,
+                                const drawing_data_t *const drawing_data,
+                                const floor_symbols_t *floor_table) {
+  set_direction_symbol(matrix_string, drawing_data->direction);
+
+  if (drawing_data->floor >= FLOOR_CODES_COUNT) {
+    return;
+  }
+
+  floor_symbols_t symbols = floor_table[drawing_data->floor];
+  if (symbols.msb != '\0') {
+    matrix_string[MSB] = symbols.msb;
+    matrix_string[LSB] = symbols.lsb;
+  }
 }
 
 /// Флаг для удержания состояния строки в темение 1 мс (максимвльная яркость,
@@ -442,16 +446,44 @@ void draw_string_on_matrix(char *matrix_string) {
   }
 }
 
-extern volatile bool is_time_ms_for_display_str_elapsed;
+/**
+ * @brief  Отображение строки развертки matrix_string (задача отображения,
+ *         вызывается по событию границы строки TIM4).
+ * @note   Первый проход переходит к следующей строке по флагу TIM4 (символы,
+ *         включенные до перехода, гаснут), второй - включает все символы
+ *         новой строки. Строка удерживается до следующей границы.
+ * @param  matrix_string: Указатель на строку для отображения.
+ * @retval None
+ */
+void draw_string_row(char *matrix_string) {
+  draw_string_on_matrix(matrix_string);
+  draw_string_on_matrix(matrix_string);
+}
+
+/// Флаг для отображения строки в течение TIME_DISPLAY_STRING_DURING_MS
+static volatile bool is_time_ms_for_display_str_elapsed = false;
+
+/// Таймер отображения строки в течение TIME_DISPLAY_STRING_DURING_MS
+static timer_wheel_timer_t display_str_timer;
+
+/**
+ * @brief  Завершение отображения строки (колбек display_str_timer).
+ * @param  None
+ * @retval None
+ */
+static void display_str_elapsed() { is_time_ms_for_display_str_elapsed = true; }
+
 /**
  * @brief  Отображение символов на матрице в течение
- *         TIME_DISPLAY_STRING_DURING_MS (определено в tim.c)
- * @note   Для DEMO_MODE и для протоколов при запуске индикатора.
+ *         TIME_DISPLAY_STRING_DURING_MS.
+ * @note   Для DEMO_MODE (заставка протоколов при запуске - startup.c).
  * @param  matrix_string: Указатель на строку, которая будет отображаться.
  * @retval None
  */
 void display_symbols_during_ms(char *matrix_string) {
   is_time_ms_for_display_str_elapsed = false;
+  timer_wheel_start_once(&display_str_timer, TIME_DISPLAY_STRING_DURING_MS,
+                         display_str_elapsed);
 
   while (!is_time_ms_for_display_str_elapsed) {
     draw_string_on_matrix(matrix_string);
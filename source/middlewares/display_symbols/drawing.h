@@ -23,14 +23,53 @@ typedef struct drawing_data {
   directionType direction;
 } drawing_data_t;
 
+#define FLOOR_CODES_COUNT                                                      \
+  64 ///< Кол-во кодов этажа в таблице протокола (6-битный код)
+
 /**
- * Структура содержит код местоположения и соответствующую ему строку для
- * отображения (для протоколов).
+ * Символы этажа в matrix_string (MSB, LSB) для кода этажа (для протоколов).
+ * msb == '\0' - код без символов, строка не изменяется.
  */
 typedef struct {
-  uint16_t code_location;
-  char symbols[3];
-} code_location_symbols_t;
+  char msb;
+  char lsb;
+} floor_symbols_t;
+
+/**
+ * Генерация таблицы floor_symbols_t[FLOOR_CODES_COUNT] при компиляции:
+ * ENTRY(code) - макрос протокола, инициализатор строки для кода этажа.
+ */
+#define FLOOR_TABLE_ROW_8(ENTRY, code)                                         \
+  ENTRY((code)), ENTRY((code) + 1), ENTRY((code) + 2), ENTRY((code) + 3),      \
+      ENTRY((code) + 4), ENTRY((code) + 5), ENTRY((code) + 6),                 \
+      ENTRY((code) + 7)
+#define FLOOR_TABLE_64(ENTRY)                                                  \
+  {FLOOR_TABLE_ROW_8(ENTRY, 0),  FLOOR_TABLE_ROW_8(ENTRY, 8),                  \
+   FLOOR_TABLE_ROW_8(ENTRY, 16), FLOOR_TABLE_ROW_8(ENTRY, 24),                 \
+   FLOOR_TABLE_ROW_8(ENTRY, 32), FLOOR_TABLE_ROW_8(ENTRY, 40),                 \
+   FLOOR_TABLE_ROW_8(ENTRY, 48), FLOOR_TABLE_ROW_8(ENTRY, 56)}
+
+/// Номер этажа: 0..9 - "Nc", 10..99 - "NN"
+#define FLOOR_NUMBER_MSB(code) ((code) <= 9 ? '0' + (code) : '0' + (code) / 10)
+#define FLOOR_NUMBER_LSB(code) ((code) <= 9 ? 'c' : '0' + (code) % 10)
+
+/// Спец. символы: строка X(code, location, msb, lsb) списка протокола
+#define FLOOR_SPECIAL_MSB(code, location, msb, lsb)                           \
+  ((code) == (location)) ? (msb):
+#define FLOOR_SPECIAL_LSB(code, location, msb, lsb)                           \
+  ((code) == (location)) ? (lsb):
+
+/**
+ * Инициализатор строки таблицы: номера этажей до max_number, затем спец.
+ * символы из списка SPECIAL_LIST(X, code), остальные коды - без символов.
+ */
+#define FLOOR_SYMBOLS_ENTRY(code, max_number, SPECIAL_LIST)                    \
+  {(code) <= (max_number)                                                      \
+       ? FLOOR_NUMBER_MSB(code)                                                \
+       : SPECIAL_LIST(FLOOR_SPECIAL_MSB, code) '\0',                           \
+   (code) <= (max_number)                                                      \
+       ? FLOOR_NUMBER_LSB(code)                                                \
+       : SPECIAL_LIST(FLOOR_SPECIAL_LSB, code) '\0'}
 
 /**
  * Индексы строки, которая будет отображаться на матрице.
@@ -51,24 +90,29 @@ void drawing_data_setter(drawing_data_t *drawing_data, uint16_t floor,
                          directionType direction);
 
 /**
- * @brief  Установка строки для отображения.
- * @param  matrix_string:                 Указатель на строку.
- * @param  drawing_data:                  Указатель на структуру с этажом и
- *                                        направлением движения.
- * @param  max_positive_number_location:  Максимвльное значение для
- *                                        положительного номера этажа в
- *                                        протоколе.
- * @param  special_symbols_code_location: Указатель на буфер с символами для
- *                                        спец. режимов/символов протокола.
- * @param  spec_symbols_buff_size:        Кол-во элементов в буфере
- *                                        special_symbols_code_location.
+ * @brief  Установка строки для отображения (номер этажа).
+ * @param  matrix_string:                Указатель на строку.
+ * @param  drawing_data:                 Указатель на структуру с этажом и
+ *                                       направлением движения.
+ * @param  max_positive_number_location: Максимвльное значение для
+ *                                       положительного номера этажа.
  * @retval None
  */
 void setting_symbols(char *matrix_string,
                      const drawing_data_t *const drawing_data,
-                     uint8_t max_positive_number_location,
-                     const code_location_symbols_t *code_location_symbols,
-                     uint8_t spec_symbols_buff_size);
+                     uint8_t max_positive_number_location);
+
+/**
+ * @brief  Установка строки для отображения по таблице протокола.
+ * @param  matrix_string: Указатель на строку.
+ * @param  drawing_data:  Указатель на структуру с этажом и направлением
+ *                        движения.
+ * @param  floor_table:   Таблица символов протокола (FLOOR_TABLE_64).
+ * @retval None
+ */
+void setting_symbols_from_table(char *matrix_string,
+                                const drawing_data_t *const drawing_data,
+                                const floor_symbols_t *floor_table);
 
 /**
  * @brief  Отображение matrix_string в зависимости от типа строки.
@@ -77,6 +121,14 @@ void setting_symbols(char *matrix_string,
  */
 void draw_string_on_matrix(char *matrix_string);
 
+/**
+ * @brief  Отображение строки развертки matrix_string (задача отображения,
+ *         вызывается по событию границы строки TIM4).
+ * @param  matrix_string: Указатель на строку для отображения.
+ * @retval None
+ */
+void draw_string_row(char *matrix_string);
+
 /**
  * @brief Преобразование числа в символ (для этажей 0..9).
  *
@@ -87,8 +139,8 @@ char convert_int_to_char(uint8_t number);
 
 /**
  * @brief  Отображение символов на матрице в течение
- *         TIME_DISPLAY_STRING_DURING_MS (определено в tim.c)
- * @note   Для DEMO_MODE и для протоколов при запуске индикатора.
+ *         TIME_DISPLAY_STRING_DURING_MS (определено в drawing.c)
+ * @note   Для DEMO_MODE (заставка протоколов при запуске - startup.c).
  * @param  matrix_string: Указатель на строку, которая будет отображаться.
  * @retval None
  */
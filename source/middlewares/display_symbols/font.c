@@ -122,6 +122,12 @@ static symbol_t symbols[] = {
     {'T',
      {0b01111100, 0b00010000, 0b00010000, 0b00010000, 0b00010000, 0b00010000,
       0b00010000, 0b00010000}},
+    {'G',
+     {0b00110000, 0b01001000, 0b01000000, 0b01000000, 0b01011000, 0b01001000,
+      0b01001000, 0b00111000}},
+    {'M',
+     {0b01000100, 0b01101100, 0b01010100, 0b01010100, 0b01000100, 0b01000100,
+      0b01000100, 0b01000100}},
     {'.',
      {0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000, 0b00000000,
       0b00000000, 0b01000000}},
@@ -0,0 +1,82 @@
+/**
+ * @file    async_delay.h
+ * @brief   Этот файл содержит макросы неблокирующих задержек для
+ *          последовательностей шагов (продолжение после задержки).
+ */
+#ifndef __ASYNC_DELAY_H__
+#define __ASYNC_DELAY_H__
+
+#include "main.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Состояние последовательности (память - у владельца, обычно static). Нулевая
+ * структура - последовательность с начала.
+ *
+ * Последовательность - функция, возвращающая bool и вызываемая повторно из
+ * главного цикла (задачи): шаги записываются подряд между ASYNC_BEGIN() и
+ * ASYNC_END(), на задержке функция возвращает false и при следующем вызове
+ * продолжает после задержки. Локальные переменные между вызовами не
+ * сохраняются (использовать static), switch внутри последовательности не
+ * использовать, точка продолжения - номер строки (не больше одного
+ * ASYNC_DELAY_MS()/ASYNC_AWAIT() в строке).
+ */
+typedef struct {
+  uint16_t line;     // Точка продолжения (__LINE__), 0 - начало
+  uint32_t start_ms; // Начало текущей задержки (HAL_GetTick)
+} async_t;
+
+/**
+ * @brief  Начало последовательности: переход к точке продолжения.
+ * @param  async: Указатель на состояние последовательности.
+ */
+#define ASYNC_BEGIN(async)                                                     \
+  switch ((async)->line) {                                                     \
+  case 0:
+
+/**
+ * @brief  Неблокирующая задержка: возврат false до истечения delay_ms, затем
+ *         продолжение со следующего шага.
+ * @param  async:    Указатель на состояние последовательности.
+ * @param  delay_ms: Задержка в мс.
+ */
+#define ASYNC_DELAY_MS(async, delay_ms)                                        \
+  do {                                                                         \
+    (async)->start_ms = HAL_GetTick();                                         \
+    (async)->line = __LINE__;                                                  \
+    __attribute__((fallthrough));                                              \
+  case __LINE__:                                                               \
+    if (HAL_GetTick() - (async)->start_ms < (uint32_t)(delay_ms)) {            \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief  Ожидание условия (например, завершения вложенной
+ *         последовательности): возврат false, пока condition ложно.
+ * @param  async:     Указатель на состояние последовательности.
+ * @param  condition: Условие продолжения.
+ */
+#define ASYNC_AWAIT(async, condition)                                          \
+  do {                                                                         \
+    (async)->line = __LINE__;                                                  \
+    __attribute__((fallthrough));                                              \
+  case __LINE__:                                                               \
+    if (!(condition)) {                                                        \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief  Конец последовательности: возврат true (последовательность
+ *         завершена, следующий вызов начинает ее сначала).
+ * @param  async: Указатель на состояние последовательности.
+ */
+#define ASYNC_END(async)                                                       \
+  }                                                                            \
+  (async)->line = 0;                                                           \
+  return true
+
+#endif /* __ASYNC_DELAY_H__ */
@@ -26,23 +26,31 @@ void set_active_buzzer_state(states_t state) {
 
 /**
  * @brief  Установка мелодии для пассивного бузера (TEST_MODE).
+ * @note   Не блокирует: вызывается повторно до возврата true (тон - 250 мс).
+ * @param  async:     Указатель на состояние последовательности.
  * @param  freq_buff: Буфер с частотами для тонов.
  * @param  buff_size: Размер freq_buff.
- * @retval None
+ * @retval true, если мелодия завершена.
  */
-void set_passive_buzzer_melody(const uint16_t *freq_buff, uint8_t buff_size) {
-  for (uint8_t ind_freq = 0; ind_freq < buff_size; ind_freq++) {
+bool set_passive_buzzer_melody(async_t *async, const uint16_t *freq_buff,
+                               uint8_t buff_size) {
+  /// Индекс текущего тона (сохраняется между вызовами).
+  static uint8_t ind_freq = 0;
+
+  ASYNC_BEGIN(async);
+  for (ind_freq = 0; ind_freq < buff_size; ind_freq++) {
     TIM2_Start_bip(freq_buff[ind_freq], VOLUME_1);
-    TIM3_Delay_ms(250);
+    ASYNC_DELAY_MS(async, 250);
   }
   TIM2_Stop_bip();
+  ASYNC_END(async);
 }
 
 // enum { BIP_DURATION_GONG, BIP_DURATION_DOORS, BIP_DURATION_CALL_BTN };
 
 /**
- * @brief  Старт воспроизведения гонга (1, 2, 3 тона), запуск TIM1 для подсчета
- *         продолжительности тона.
+ * @brief  Старт воспроизведения гонга (1, 2, 3 тона), смена тонов - по
+ *         таймеру колеса таймеров.
  * @param  bip_counter:   Кол-во тонов.
  * @param  bip_frequency: Частота стартового тона.
  * @param  volume:        Уровень громкости тона.
@@ -50,8 +58,6 @@ void set_passive_buzzer_melody(const uint16_t *freq_buff, uint8_t buff_size) {
  */
 void play_gong(uint8_t bip_counter, uint16_t bip_frequency, uint8_t volume,
                bip_duration_e duration_type) {
-  TIM1_Start();
-
   switch (duration_type) {
   case BIP_DURATION_GONG: // gong
     TIM2_Set_pwm_sound(bip_frequency, bip_counter, BIP_DURATION_MS, volume);
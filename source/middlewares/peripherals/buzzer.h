@@ -5,6 +5,7 @@
 #ifndef __BUZZER_H__
 #define __BUZZER_H__
 
+#include "async_delay.h"
 #include "main.h"
 
 #include <stdbool.h>
@@ -37,15 +38,18 @@ void set_active_buzzer_state(states_t state);
 
 /**
  * @brief  Установка мелодии для пассивного бузера (TEST_MODE).
+ * @note   Не блокирует: вызывается повторно до возврата true (тон - 250 мс).
+ * @param  async:     Указатель на состояние последовательности.
  * @param  freq_buff: Буфер с частотами для тонов.
  * @param  buff_size: Размер freq_buff.
- * @retval None
+ * @retval true, если мелодия завершена.
  */
-void set_passive_buzzer_melody(const uint16_t *freq_buff, uint8_t buff_size);
+bool set_passive_buzzer_melody(async_t *async, const uint16_t *freq_buff,
+                               uint8_t buff_size);
 
 /**
- * @brief  Старт воспроизведения гонга (1, 2, 3 тона), запуск TIM1 для подсчета
- *         продолжительности тона.
+ * @brief  Старт воспроизведения гонга (1, 2, 3 тона), смена тонов - по
+ *         таймеру колеса таймеров.
  * @param  bip_counter:   Кол-во тонов.
  * @param  bip_frequency: Частота стартового тона.
  * @param  volume:        Уровень громкости тона.
@@ -0,0 +1,89 @@
+/**
+ * @file clock_governor.c
+ */
+#include "clock_governor.h"
+
+#include "main.h"
+
+/// Поля делителей AHB, APB1 и APB2 в RCC->CFGR.
+#define CFGR_PRESCALERS_MASK (RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)
+
+_Static_assert(SYSCLK_APB_DIV == 4,
+               "Clock levels keep APB clocks at SYSCLK / 4 (AHB x APB = 4)");
+
+/// Делители AHB, APB1 и APB2 уровня (индекс - clock_level_t): AHB x APB = 4.
+static const uint32_t level_prescalers[] = {
+    [CLOCK_LEVEL_ECO] =
+        RCC_CFGR_HPRE_DIV2 | RCC_CFGR_PPRE1_DIV2 | RCC_CFGR_PPRE2_DIV2,
+    [CLOCK_LEVEL_FULL] =
+        RCC_CFGR_HPRE_DIV1 | RCC_CFGR_PPRE1_DIV4 | RCC_CFGR_PPRE2_DIV4,
+};
+
+/// Частота ядра уровня в Гц (индекс - clock_level_t).
+static const uint32_t level_hclk[] = {
+    [CLOCK_LEVEL_ECO] = SYSCLK_FREQ / 2,
+    [CLOCK_LEVEL_FULL] = SYSCLK_FREQ,
+};
+
+/// Текущий уровень (SystemClock_Config() - CLOCK_LEVEL_FULL).
+static clock_level_t level = CLOCK_LEVEL_FULL;
+
+/// Маска запросов CLOCK_LEVEL_FULL (бит - clock_burst_t).
+static uint32_t burst_mask = 0;
+
+/**
+ * @brief  Переключение уровня частоты ядра.
+ * @note   1. Делители AHB и APB меняются одной записью RCC->CFGR: частоты
+ *            APB1/APB2 (CAN) и таймеров (развертка, шкала времени, бузер)
+ *            не меняются, поэтому CAN и таймеры не перенастраиваются и
+ *            продолжают работу без пропусков;
+ *         2. От частоты ядра зависит только SysTick: период пересчитывается
+ *            (HAL_InitTick()), текущий тик удлиняется не больше чем на 1 мс;
+ *         3. Задержка flash-памяти остается для SYSCLK_FREQ (допустима и
+ *            для меньшей частоты).
+ * @param  new_level: Новый уровень.
+ * @retval None
+ */
+static void set_level(clock_level_t new_level) {
+  if (new_level == level) {
+    return;
+  }
+
+  __disable_irq();
+  RCC->CFGR = (RCC->CFGR & ~CFGR_PRESCALERS_MASK) | level_prescalers[new_level];
+  SystemCoreClock = level_hclk[new_level];
+  HAL_InitTick(uwTickPrio);
+  level = new_level;
+  __enable_irq();
+}
+
+/**
+ * @brief  Запрос уровня CLOCK_LEVEL_FULL (переключение сразу).
+ * @note   Вызывается из главного цикла (не из прерывания).
+ * @param  burst: Источник запроса.
+ * @retval None
+ */
+void clock_governor_request(clock_burst_t burst) {
+  burst_mask |= 1UL << burst;
+  set_level(CLOCK_LEVEL_FULL);
+}
+
+/**
+ * @brief  Снятие запроса: CLOCK_LEVEL_ECO, если запросов больше нет.
+ * @note   Вызывается из главного цикла (не из прерывания).
+ * @param  burst: Источник запроса.
+ * @retval None
+ */
+void clock_governor_release(clock_burst_t burst) {
+  burst_mask &= ~(1UL << burst);
+  if (burst_mask == 0) {
+    set_level(CLOCK_LEVEL_ECO);
+  }
+}
+
+/**
+ * @brief  Текущий уровень частоты ядра.
+ * @param  None
+ * @retval Уровень clock_level_t.
+ */
+clock_level_t clock_governor_get_level(void) { return level; }
@@ -0,0 +1,51 @@
+/**
+ * @file    clock_governor.h
+ * @brief   Этот файл содержит прототипы функций для файла clock_governor.c
+ */
+#ifndef __CLOCK_GOVERNOR_H__
+#define __CLOCK_GOVERNOR_H__
+
+#include <stdint.h>
+
+/**
+ * Частота ядра (HCLK). Частоты APB1/APB2, таймеров и CAN на обоих уровнях
+ * одинаковые (SYSCLK_FREQ / SYSCLK_APB_DIV, см. main.h).
+ */
+typedef enum {
+  CLOCK_LEVEL_ECO,  // HCLK = SYSCLK / 2 (установившийся режим)
+  CLOCK_LEVEL_FULL, // HCLK = SYSCLK (запуск и пиковая нагрузка)
+} clock_level_t;
+
+/**
+ * Источники запроса уровня CLOCK_LEVEL_FULL (бит маски запросов).
+ */
+typedef enum {
+  CLOCK_BURST_LOAD,  // Доля простоя планировщика ниже порога
+  CLOCK_BURST_FLASH, // Запись настроек или надписей этажей во flash-память
+  CLOCK_BURST_COUNT
+} clock_burst_t;
+
+/**
+ * @brief  Запрос уровня CLOCK_LEVEL_FULL (переключение сразу).
+ * @note   Вызывается из главного цикла (не из прерывания).
+ * @param  burst: Источник запроса.
+ * @retval None
+ */
+void clock_governor_request(clock_burst_t burst);
+
+/**
+ * @brief  Снятие запроса: CLOCK_LEVEL_ECO, если запросов больше нет.
+ * @note   Вызывается из главного цикла (не из прерывания).
+ * @param  burst: Источник запроса.
+ * @retval None
+ */
+void clock_governor_release(clock_burst_t burst);
+
+/**
+ * @brief  Текущий уровень частоты ядра.
+ * @param  None
+ * @retval Уровень clock_level_t.
+ */
+clock_level_t clock_governor_get_level(void);
+
+#endif /* __CLOCK_GOVERNOR_H__ */
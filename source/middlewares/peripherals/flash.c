@@ -3,10 +3,15 @@
  */
 #include "flash.h"
 
+#include "clock_governor.h"
+
 #define LOW_HALF_WORD_MASK                                                     \
   0xFF ///< Маска 16 bits для 2-х байт данных: addr_id (8 bits) and volume (8
        ///< bits)
 
+#define CAN_BITRATE_OFFSET 16 ///< Смещение байта скорости CAN в слове настроек
+#define PROTOCOL_OFFSET 24    ///< Смещение байта протокола в слове настроек
+
 /// Структура для секции SETTINGS, объявленнной в скрипте компоновщика
 /// CubeMX/.ld
 static settings_t settings_flash
@@ -44,15 +49,18 @@ static HAL_StatusTypeDef erase_settings(void) {
 }
 
 /**
- * @brief  Запись слова (WORD, 32 бита) во flash-память: адрес индикатора и
- *         уровень громкости бузера (Например: 0xFFFF022D).
- * @param  addr_id: Адрес индикатора.
- * @param  volume:  Уровень громкости бузера.
- * @retval status:  HAL Status.
+ * @brief  Запись слова (WORD, 32 бита) во flash-память: протокол, индекс
+ *         скорости CAN, адрес индикатора и уровень громкости бузера
+ *         (Например: 0x0000022D).
+ * @param  settings: Указатель на структуру с настройками.
+ * @retval status:   HAL Status.
  */
-static HAL_StatusTypeDef write_settings(uint8_t addr_id, volume_t volume) {
-  // 2 байта: addr_id и volume, первые 2 байта заполнены 0xFFFF
-  uint32_t packed_data = (addr_id << 8) | (uint8_t)volume | (0xFFFF << 16);
+static HAL_StatusTypeDef write_settings(const settings_t *settings) {
+  // 4 байта: protocol, can_bitrate, addr_id и volume
+  uint32_t packed_data =
+      ((uint32_t)settings->protocol << PROTOCOL_OFFSET) |
+      ((uint32_t)settings->can_bitrate << CAN_BITRATE_OFFSET) |
+      (settings->addr_id << 8) | (uint8_t)settings->volume;
 
   HAL_StatusTypeDef status = erase_settings();
   if (status != HAL_OK) {
@@ -78,8 +86,11 @@ static HAL_StatusTypeDef write_settings(uint8_t addr_id, volume_t volume) {
 }
 
 /**
- * @brief  Чтение адреса индикатора и уровня громкости бузера из Flash-памяти в
- *         структуру.
+ * @brief  Чтение адреса индикатора, уровня громкости бузера, скорости CAN и
+ *         протокола из Flash-памяти в структуру.
+ * @note   В прошивках до версии с автоопределением скорости байт can_bitrate
+ *         записывался как 0xFF, поэтому он читается как "скорость неизвестна".
+ *         Аналогично байт protocol 0xFF - "протокол не выбран".
  * @param  settings: Указатель на структуру с настройками.
  * @retval status:   HAL Status.
  */
@@ -88,22 +99,30 @@ HAL_StatusTypeDef read_settings(settings_t *settings) {
 
   settings->addr_id = (packed_data >> 8) & LOW_HALF_WORD_MASK;
   settings->volume = (volume_t)(packed_data & LOW_HALF_WORD_MASK);
+  settings->can_bitrate =
+      (packed_data >> CAN_BITRATE_OFFSET) & LOW_HALF_WORD_MASK;
+  settings->protocol = (packed_data >> PROTOCOL_OFFSET) & LOW_HALF_WORD_MASK;
 
   return HAL_OK;
 }
 
 /**
  * @brief  Перезапись настроек, если есть изменения.
+ * @note   Запись - на полной частоте ядра (CLOCK_BURST_FLASH).
  * @param  settings: Указатель на структуру с настройками.
  * @retval None
  */
 void overwrite_settings(settings_t *settings) {
-  settings_t current_flash_settings = {1, 1};
+  settings_t current_flash_settings = {1, 1, 0xFF, 0xFF};
   read_settings(&current_flash_settings);
 
   if (current_flash_settings.addr_id != settings->addr_id ||
-      current_flash_settings.volume != settings->volume) {
-    write_settings(settings->addr_id, settings->volume);
+      current_flash_settings.volume != settings->volume ||
+      current_flash_settings.can_bitrate != settings->can_bitrate ||
+      current_flash_settings.protocol != settings->protocol) {
+    clock_governor_request(CLOCK_BURST_FLASH);
+    write_settings(settings);
+    clock_governor_release(CLOCK_BURST_FLASH);
   }
 }
 
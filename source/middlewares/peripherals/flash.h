@@ -11,13 +11,15 @@
  * Структура для хранения настроек индикатора.
  */
 typedef struct {
-  uint8_t addr_id; // Адрес индикатора
-  volume_t volume; // Уровень громкости бузера
+  uint8_t addr_id;     // Адрес индикатора
+  volume_t volume;     // Уровень громкости бузера
+  uint8_t can_bitrate; // Индекс скорости CAN (can_bitrate_t из can.h)
+  uint8_t protocol;    // Протокол (protocol_id_t из protocol_selection.h)
 } settings_t;
 
 /**
- * @brief  Чтение адреса индикатора и уровня громкости бузера из Flash-памяти в
- *         структуру.
+ * @brief  Чтение адреса индикатора, уровня громкости бузера, скорости CAN и
+ *         протокола из Flash-памяти в структуру.
  * @param  settings: Указатель на структуру с настройками.
  * @retval status:   HAL Status.
  */
@@ -0,0 +1,185 @@
+/**
+ * @file floor_labels.c
+ */
+#include "floor_labels.h"
+
+#include "font.h"
+#include "fw_update_protocol.h"
+
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert(sizeof(floor_labels_page_t) <= FLASH_PAGE_SIZE,
+               "floor labels must fit one flash page");
+_Static_assert(sizeof(floor_symbols_t) == 2,
+               "floor labels use a fixed 2-byte stride");
+
+/// Страница LABELS, объявленная в скрипте компоновщика CubeMX/.ld
+static floor_labels_page_t labels_flash
+    __attribute__((__section__(".floor_labels"), used));
+
+/// Таблица протокола (если страница LABELS не записана)
+static const floor_symbols_t *protocol_table = NULL;
+
+/// Текущая таблица (читается декодером протокола в прерывании CAN)
+static const floor_symbols_t *volatile active_table = NULL;
+
+/// Копия таблицы для изменения надписей по CAN
+static floor_symbols_t staging_labels[FLOOR_CODES_COUNT];
+
+/**
+ * @brief  Проверка страницы LABELS.
+ * @param  None
+ * @retval true, если таблица записана полностью и CRC совпала.
+ */
+static bool is_flash_labels_valid(void) {
+  return labels_flash.magic == FLOOR_LABELS_MAGIC &&
+         labels_flash.crc ==
+             fw_update_crc32(0, (const uint8_t *)labels_flash.labels,
+                             sizeof(labels_flash.labels));
+}
+
+/**
+ * @brief  Стирание страницы LABELS (раздел LABELS объявлен в файле .ld).
+ * @note   Прерывания не запрещаются: стирание страницы длится ~20 мс, чтение
+ *         flash в прерываниях ожидает его окончания, но запросы прерываний
+ *         не теряются.
+ * @param  None
+ * @retval status: HAL Status.
+ */
+static HAL_StatusTypeDef erase_labels(void) {
+  FLASH_EraseInitTypeDef EraseInitStruct = {
+      .TypeErase = FLASH_TYPEERASE_PAGES,
+      .PageAddress = (uint32_t)&labels_flash,
+      .NbPages = 1,
+  };
+  uint32_t page_error = 0;
+
+  // Декодер не должен читать страницу во время стирания
+  active_table = protocol_table;
+
+  HAL_FLASH_Unlock();
+  HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&EraseInitStruct, &page_error);
+  HAL_FLASH_Lock();
+
+  return status;
+}
+
+/**
+ * @brief  Запись слов (WORD, 32 бита) во flash-память.
+ * @note   Прерывания запрещаются только на запись одного слова (два
+ *         полуслова, не больше ~140 мкс).
+ * @param  address: Адрес первого слова.
+ * @param  data:    Указатель на данные (выровнены по 4 байта).
+ * @param  size:    Кол-во байт (кратно 4).
+ * @retval status:  HAL Status.
+ */
+static HAL_StatusTypeDef program_words(uint32_t address, const uint32_t *data,
+                                       uint32_t size) {
+  HAL_StatusTypeDef status = HAL_OK;
+
+  HAL_FLASH_Unlock();
+  for (uint32_t i = 0; i < size / 4 && status == HAL_OK; i++) {
+    __disable_irq();
+    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address + i * 4,
+                               data[i]);
+    __enable_irq();
+  }
+  HAL_FLASH_Lock();
+
+  return status;
+}
+
+/**
+ * @brief  Выбор таблицы символов этажа: страница LABELS, если она записана и
+ *         CRC совпала, иначе таблица протокола.
+ * @param  default_table: Таблица протокола (FLOOR_TABLE_64).
+ * @retval None
+ */
+void floor_labels_init(const floor_symbols_t *default_table) {
+  protocol_table = default_table;
+  active_table = is_flash_labels_valid() ? labels_flash.labels : default_table;
+
+  memcpy(staging_labels, (const void *)active_table, sizeof(staging_labels));
+}
+
+/**
+ * @brief  Получение текущей таблицы символов этажа (для декодера протокола).
+ * @param  None
+ * @retval Указатель на таблицу из FLOOR_CODES_COUNT элементов.
+ */
+const floor_symbols_t *floor_labels_table(void) { return active_table; }
+
+/**
+ * @brief  Изменение надписи в копии таблицы в RAM (до floor_labels_commit()).
+ * @note   Символы проверяются по шрифту (get_symbol_code()).
+ * @param  code: Код этажа.
+ * @param  msb:  Символ старшего разряда, '\0' - код без символов.
+ * @param  lsb:  Символ младшего разряда.
+ * @retval true, если код этажа и символы допустимы.
+ */
+bool floor_labels_set(uint8_t code, char msb, char lsb) {
+  if (code >= FLOOR_CODES_COUNT) {
+    return false;
+  }
+
+  if (msb != '\0' &&
+      (get_symbol_code(msb) == NULL || get_symbol_code(lsb) == NULL)) {
+    return false;
+  }
+
+  staging_labels[code].msb = msb;
+  staging_labels[code].lsb = msb != '\0' ? lsb : '\0';
+  return true;
+}
+
+/**
+ * @brief  Запись копии таблицы из RAM в страницу LABELS.
+ * @note   На время стирания и записи декодер использует таблицу протокола.
+ * @param  None
+ * @retval status: HAL Status.
+ */
+HAL_StatusTypeDef floor_labels_commit(void) {
+  static uint32_t labels_words[sizeof(staging_labels) / 4];
+  memcpy(labels_words, staging_labels, sizeof(labels_words));
+
+  uint32_t header[2] = {
+      FLOOR_LABELS_MAGIC,
+      fw_update_crc32(0, (const uint8_t *)labels_words, sizeof(labels_words)),
+  };
+
+  HAL_StatusTypeDef status = erase_labels();
+
+  // Таблица, затем CRC и признак записи (последним)
+  if (status == HAL_OK) {
+    status = program_words((uint32_t)labels_flash.labels, labels_words,
+                           sizeof(labels_words));
+  }
+  if (status == HAL_OK) {
+    status = program_words((uint32_t)&labels_flash.crc, &header[1], 4);
+  }
+  if (status == HAL_OK) {
+    status = program_words((uint32_t)&labels_flash.magic, &header[0], 4);
+  }
+
+  if (status == HAL_OK && !is_flash_labels_valid()) {
+    status = HAL_ERROR;
+  }
+
+  if (status == HAL_OK) {
+    active_table = labels_flash.labels;
+  }
+  return status;
+}
+
+/**
+ * @brief  Стирание страницы LABELS (возврат к таблице протокола).
+ * @param  None
+ * @retval status: HAL Status.
+ */
+HAL_StatusTypeDef floor_labels_clear(void) {
+  HAL_StatusTypeDef status = erase_labels();
+
+  memcpy(staging_labels, protocol_table, sizeof(staging_labels));
+  return status;
+}
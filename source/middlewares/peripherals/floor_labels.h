@@ -0,0 +1,70 @@
+/**
+ * @file    floor_labels.h
+ * @brief   Этот файл содержит прототипы функций для файла floor_labels.c
+ */
+#ifndef __FLOOR_LABELS_H__
+#define __FLOOR_LABELS_H__
+
+#include "drawing.h"
+#include "main.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FLOOR_LABELS_MAGIC                                                     \
+  0x4C424C46U ///< Признак записанной таблицы надписей ("FLBL")
+
+/**
+ * Страница LABELS: таблица символов этажа с фиксированным шагом (2 байта на
+ * код этажа), индексируется кодом этажа напрямую.
+ * @note magic записывается последним, поэтому страница с частично записанной
+ *       таблицей не используется.
+ */
+typedef struct {
+  uint32_t magic;                             // FLOOR_LABELS_MAGIC
+  uint32_t crc;                               // CRC-32 таблицы labels
+  floor_symbols_t labels[FLOOR_CODES_COUNT]; // Символы этажа по коду
+} floor_labels_page_t;
+
+/**
+ * @brief  Выбор таблицы символов этажа: страница LABELS, если она записана и
+ *         CRC совпала, иначе таблица протокола.
+ * @param  default_table: Таблица протокола (FLOOR_TABLE_64).
+ * @retval None
+ */
+void floor_labels_init(const floor_symbols_t *default_table);
+
+/**
+ * @brief  Получение текущей таблицы символов этажа (для декодера протокола).
+ * @param  None
+ * @retval Указатель на таблицу из FLOOR_CODES_COUNT элементов.
+ */
+const floor_symbols_t *floor_labels_table(void);
+
+/**
+ * @brief  Изменение надписи в копии таблицы в RAM (до floor_labels_commit()).
+ * @note   msb == '\0' - код без символов (строка не изменяется).
+ * @param  code: Код этажа.
+ * @param  msb:  Символ старшего разряда (из font.c symbols[]).
+ * @param  lsb:  Символ младшего разряда (из font.c symbols[]).
+ * @retval true, если код этажа и символы допустимы.
+ */
+bool floor_labels_set(uint8_t code, char msb, char lsb);
+
+/**
+ * @brief  Запись копии таблицы из RAM в страницу LABELS.
+ * @note   Блокирует на время стирания страницы, вызывается из главного цикла.
+ * @param  None
+ * @retval status: HAL Status.
+ */
+HAL_StatusTypeDef floor_labels_commit(void);
+
+/**
+ * @brief  Стирание страницы LABELS (возврат к таблице протокола).
+ * @note   Блокирует на время стирания страницы, вызывается из главного цикла.
+ * @param  None
+ * @retval status: HAL Status.
+ */
+HAL_StatusTypeDef floor_labels_clear(void);
+
+#endif /* __FLOOR_LABELS_H__ */
@@ -22,7 +22,7 @@
 #include "gpio.h"
 
 /* USER CODE BEGIN 0 */
-
+#include "irq_priority.h"
 /* USER CODE END 0 */
 
 /*----------------------------------------------------------------------------*/
@@ -94,7 +94,7 @@ void MX_GPIO_Init(void) {
   HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
   /* EXTI interrupt init*/
-  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 1, 0);
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, IRQ_PRIORITY_BUTTONS, 0);
   HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
 }
 
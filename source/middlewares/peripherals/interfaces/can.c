@@ -22,9 +22,22 @@
 
 /* USER CODE BEGIN 0 */
 #include "config.h"
+#include "irq_priority.h"
+#include "timebase.h"
 
 #if PROTOCOL_UIM_6100
-msg_t msg = {0, 0, 0, 0};
+#include "clock_governor.h"
+#include "diagnostics.h"
+#include "floor_labels.h"
+#include "fw_update_protocol.h"
+#include "watchdog.h"
+
+/// Запрос загрузчика (.noinit RAM сохраняется при перезапуске, см. .ld).
+static volatile uint32_t boot_request
+    __attribute__((__section__(".noinit"), used));
+
+/// Команда надписей этажей для записи во flash в главном цикле (0 - нет).
+static volatile uint8_t pending_label_cmd = 0;
 #endif
 
 #include <stdbool.h>
@@ -33,20 +46,171 @@ msg_t msg = {0, 0, 0, 0};
 #define FILTER_11_BIT_ID_OFFSET                                                \
   5 ///< Смещение для стандартного фильтра идентификации кадра.
 
-/// Структура заголовка для получения данных.
-static CAN_RxHeaderTypeDef rx_header;
+#define CAN_AUTOBAUD_LISTEN_MS                                                 \
+  500 ///< Время прослушивания шины на одной скорости при автоопределении
+#define CAN_AUTOBAUD_FRAMES_TO_LOCK                                            \
+  2 ///< Кол-во кадров без ошибок для фиксации скорости
+#define CAN_AUTOBAUD_TIMEOUT_MS                                                \
+  3000 ///< Максимальное время автоопределения скорости
+#define CAN_AUTOBAUD_RELEARN_MS                                                \
+  10000 ///< Время без кадров до повторного автоопределения скорости
+#define CAN_AUTOBAUD_RELEARN_MAX_MS                                            \
+  160000 ///< Максимальное время без кадров между повторными попытками
+#define CAN_AUTOBAUD_PENDING                                                   \
+  0xFE ///< Результат шага автоопределения: прослушивание продолжается
+
+#define CAN_RECOVERY_BACKOFF_MIN_MS                                            \
+  10 ///< Задержка перед первой попыткой выхода из bus-off
+#define CAN_RECOVERY_BACKOFF_MAX_MS                                            \
+  640 ///< Максимальная задержка между попытками выхода из bus-off
+#define CAN_RECOVERY_HOLD_FLOOR_MS                                             \
+  5000 ///< Время отображения последнего этажа во время восстановления
+#define CAN_INIT_ACK_TIMEOUT_MS                                                \
+  2 ///< Время ожидания входа bxCAN в режим инициализации
 
-/// Буфер для полученных данных.
-static uint8_t rx_data_can[BUFFER_SIZE_BYTES] = {
-    0x00,
+/**
+ * Прескелеры для скоростей can_bitrate_t (бит - CAN_TQ_PER_BIT квантов, см.
+ * main.h).
+ */
+static const uint16_t can_prescalers[CAN_BITRATE_COUNT] = {
+    [CAN_BITRATE_200_KBIT] = CAN_PRESCALER(200000),
+    [CAN_BITRATE_125_KBIT] = CAN_PRESCALER(125000),
+    [CAN_BITRATE_250_KBIT] = CAN_PRESCALER(250000),
 };
 
+/// Прескелер для MX_CAN_Init() (устанавливается через can_set_bitrate).
+static uint16_t can_prescaler = CAN_PRESCALER(200000);
+
+/**
+ * Состояние автоопределения скорости.
+ */
+typedef struct {
+  uint8_t bitrate;      // Проверяемая скорость (can_bitrate_t)
+  uint8_t valid_frames; // Кадры без ошибок на проверяемой скорости
+  uint32_t start_ms;    // Начало прослушивания скорости (HAL_GetTick)
+  uint32_t deadline_ms; // Окончание автоопределения (HAL_GetTick)
+} can_autobaud_t;
+
+_Static_assert(CAN_BITRATE_COUNT < CAN_AUTOBAUD_PENDING &&
+                   CAN_AUTOBAUD_PENDING != CAN_BITRATE_UNKNOWN,
+               "Autobaud step results must not overlap bitrate indices");
+
+#if PROTOCOL_UIM_6100
+/// Повторное автоопределение скорости после потери связи
+/// (can_relearn_process()).
+static can_autobaud_t relearn;
+
+/// Флаг повторного автоопределения скорости (прием остановлен).
+static bool is_relearning = false;
+
+/// ID фильтра приема (start_can()) для перезапуска после автоопределения.
+static uint32_t relearn_std_id = 0;
+
+/// Начало отсчета времени без кадров: последний кадр или запуск CAN.
+static volatile uint32_t silence_start_ms = 0;
+
+/// Время без кадров до повторного автоопределения: удваивается после каждой
+/// попытки (не больше CAN_AUTOBAUD_RELEARN_MAX_MS), сбрасывается кадром.
+static volatile uint32_t relearn_interval_ms = CAN_AUTOBAUD_RELEARN_MS;
+#endif
+
+/// Декодер протокола для принятых кадров (can_set_frame_decoder).
+static can_frame_decoder_t frame_decoder = NULL;
+
 /// Флаг для контроля полученных данных по CAN.
 volatile bool is_data_received = false;
 
 /// Структура заголовка для отправленных данных.
 static CAN_TxHeaderTypeDef tx_header;
 
+/**
+ * Состояния восстановления после bus-off.
+ */
+typedef enum {
+  CAN_RECOVERY_IDLE,    // Нормальная работа
+  CAN_RECOVERY_BUS_OFF, // Bus-off, ожидание попытки восстановления
+  CAN_RECOVERY_RESYNC   // Запрошен выход из bus-off, ожидание первого кадра
+} can_recovery_state_t;
+
+/// Текущее состояние восстановления после bus-off.
+static volatile can_recovery_state_t recovery_state = CAN_RECOVERY_IDLE;
+
+/// Время перехода в bus-off в мс (HAL_GetTick).
+static volatile uint32_t bus_off_start_ms = 0;
+
+/// Время следующей попытки выхода из bus-off в мс (HAL_GetTick).
+static volatile uint32_t recovery_attempt_ms = 0;
+
+/// Текущая задержка между попытками (удваивается при повторном bus-off).
+static volatile uint32_t recovery_backoff_ms = CAN_RECOVERY_BACKOFF_MIN_MS;
+
+/// Статистика восстановления после bus-off.
+static volatile can_recovery_stats_t recovery_stats = {0, 0, 0};
+
+/// Метки времени кадров протокола.
+static volatile can_rx_timing_t rx_timing = {0, 0, 0};
+
+/**
+ * @brief  Фиксация перехода в bus-off (из HAL_CAN_ErrorCallback).
+ * @note   Повторный bus-off во время восстановления удваивает задержку до
+ *         следующей попытки (не более CAN_RECOVERY_BACKOFF_MAX_MS).
+ * @param  None
+ * @retval None
+ */
+static void CAN_EnterBusOff(void) {
+  uint32_t now_ms = HAL_GetTick();
+
+  if (recovery_state == CAN_RECOVERY_IDLE) {
+    bus_off_start_ms = now_ms;
+    recovery_backoff_ms = CAN_RECOVERY_BACKOFF_MIN_MS;
+    recovery_stats.bus_off_count++;
+  } else if (recovery_backoff_ms < CAN_RECOVERY_BACKOFF_MAX_MS) {
+    recovery_backoff_ms *= 2;
+  }
+
+  recovery_attempt_ms = now_ms + recovery_backoff_ms;
+  recovery_state = CAN_RECOVERY_BUS_OFF;
+}
+
+/**
+ * @brief  Завершение восстановления по первому корректному кадру протокола.
+ * @note   Сохраняет время восстановления (от bus-off до первого кадра).
+ * @param  None
+ * @retval None
+ */
+static void CAN_FinishRecovery(void) {
+  if (recovery_state == CAN_RECOVERY_IDLE) {
+    return;
+  }
+
+  uint32_t recovery_ms = HAL_GetTick() - bus_off_start_ms;
+  recovery_stats.last_recovery_ms = recovery_ms;
+  if (recovery_ms > recovery_stats.max_recovery_ms) {
+    recovery_stats.max_recovery_ms = recovery_ms;
+  }
+
+  recovery_state = CAN_RECOVERY_IDLE;
+}
+
+/**
+ * @brief  Запрос выхода из bus-off (AutoBusOff = DISABLE).
+ * @note   По RM0008 программа входит в режим инициализации и выходит из него,
+ *         после чего bxCAN сам ждет 128 x 11 рецессивных бит и возвращается на
+ *         шину. Ожидание выхода не блокирует программу.
+ * @param  None
+ * @retval None
+ */
+static void CAN_RequestBusOffRecovery(void) {
+  SET_BIT(hcan.Instance->MCR, CAN_MCR_INRQ);
+
+  uint32_t start_ms = HAL_GetTick();
+  while ((hcan.Instance->MSR & CAN_MSR_INAK) == 0 &&
+         HAL_GetTick() - start_ms < CAN_INIT_ACK_TIMEOUT_MS) {
+  }
+
+  CLEAR_BIT(hcan.Instance->MCR, CAN_MCR_INRQ);
+}
+
 /**
  * @brief Отправка сообщений-ответов по CAN для PROTOCOL_UIM_6100.
  *
@@ -54,7 +218,7 @@ static CAN_TxHeaderTypeDef tx_header;
  * @param dlc:    Размер сообщения в байтах.
  * @param buffer: Указатель на буфер с данными для ответа.
  */
-static void can_send_answer(uint32_t stdId, uint8_t dlc, uint8_t *buffer) {
+void can_send_answer(uint32_t stdId, uint8_t dlc, uint8_t *buffer) {
   tx_header.StdId = stdId;
   tx_header.ExtId = 0;
   tx_header.RTR = CAN_RTR_DATA;
@@ -69,69 +233,210 @@ static void can_send_answer(uint32_t stdId, uint8_t dlc, uint8_t *buffer) {
   }
 }
 
+#if PROTOCOL_UIM_6100
 /**
- * @brief  Обработка прерывания: получение данных по CAN.
- *         Устанавливаем флаг is_data_received при получении данных.
- *         Для протоколов: устанавливаем счетчик alive_cnt[0] для проверки
- *         подключения интерфейса (устанавливаем alive_cnt[1] в tim.c TIM4).
- * @param  hcan: Указатель на структуру CAN_HandleTypeDef.
+ * @brief  Отправка ответа на команду от ПК (FW_CMD_STATUS).
+ * @param  result: Результат команды.
  * @retval None
  */
-void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
+static void CAN_SendFwStatus(fw_result_t result) {
+  uint8_t data[4] = {ISOTP_PCI_SF | 3, FW_CMD_STATUS, FW_STATE_IDLE,
+                     (uint8_t)result};
+
+  can_send_answer(FW_UPDATE_NODE_ID_BASE + matrix_settings.addr_id,
+                  sizeof(data), data);
+}
+
+/**
+ * @brief  Отправка поля статистики (FW_CMD_DIAG_INFO) или FW_CMD_STATUS с
+ *         FW_RESULT_BAD_DIAG, если поля нет.
+ * @param  record: Запись fw_diag_record_t.
+ * @param  select: Элемент и поле (элемент << FW_DIAG_ITEM_SHIFT | поле).
+ * @retval None
+ */
+static void CAN_SendDiagInfo(uint8_t record, uint8_t select) {
+  uint32_t value = 0;
+  if (!diagnostics_read(record, select >> FW_DIAG_ITEM_SHIFT,
+                        select & FW_DIAG_FIELD_MASK, &value)) {
+    CAN_SendFwStatus(FW_RESULT_BAD_DIAG);
+    return;
+  }
 
-  if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &rx_header, rx_data_can) ==
-      HAL_OK) {
+  uint8_t data[8] = {ISOTP_PCI_SF | 7, FW_CMD_DIAG_INFO, record, select};
+  fw_update_put_le32(&data[4], value);
 
-#if PROTOCOL_UIM_6100
+  can_send_answer(FW_UPDATE_NODE_ID_BASE + matrix_settings.addr_id,
+                  sizeof(data), data);
+}
 
-    if ((matrix_settings.addr_id == rx_header.StdId) &&
-    // Для КАБИНЫ и 47 адреса
-        (rx_header.StdId >= 46) && (rx_header.StdId != 49)) {
-      if (rx_header.DLC == 2) {
-        if ((rx_data_can[0] == 0x00) && (rx_data_can[1] == 0x00)) {
-          uint8_t buf2[6] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+/**
+ * @brief  Отправка причины последнего перезапуска (FW_CMD_RESET_INFO).
+ * @param  None
+ * @retval None
+ */
+static void CAN_SendResetInfo(void) {
+  reset_info_t info;
+  watchdog_get_reset_info(&info);
 
-          can_send_answer((uint32_t)(matrix_settings.addr_id + 0x80), 6, buf2);
-        }
+  uint8_t data[6] = {ISOTP_PCI_SF | 5, FW_CMD_RESET_INFO, (uint8_t)info.cause,
+                     info.hung_mask, (uint8_t)info.watchdog_resets,
+                     (uint8_t)(info.watchdog_resets >> 8)};
 
-      } else if (rx_header.DLC == 6) {
-        if ((rx_data_can[0] == 0x81) && (rx_data_can[1] == 0x00) &&
-            ((rx_data_can[5] & 0x80) != 0x80)) {
-          uint8_t buf2[2] = {0x81, 0x00};
+  can_send_answer(FW_UPDATE_NODE_ID_BASE + matrix_settings.addr_id,
+                  sizeof(data), data);
+}
 
-          can_send_answer((uint32_t)(matrix_settings.addr_id + 0x80), 2, buf2);
+/**
+ * @brief  Обработка команды от ПК (FW_UPDATE_HOST_ID).
+ * @note   1. FW_CMD_ENTER - перезапуск в загрузчик, который принимает образ
+ *            (остальные кадры обновления обрабатывает загрузчик);
+ *         2. FW_CMD_LABEL_SET - изменение надписи этажа в RAM, ответ сразу;
+ *         3. FW_CMD_LABEL_COMMIT/FW_CMD_LABEL_CLEAR - запись во flash в
+ *            главном цикле (can_label_command_process());
+ *         4. FW_CMD_DIAG - ответ FW_CMD_DIAG_INFO (поле статистики) сразу.
+ *         5. FW_CMD_RESET_CAUSE - ответ FW_CMD_RESET_INFO сразу.
+ * @param  frame: Указатель на принятый кадр.
+ * @retval None
+ */
+static void CAN_ProcessFwUpdateCommand(const can_rx_frame_t *frame) {
+  uint8_t sf_len = can_frame_byte(frame, 0) & ISOTP_SF_LEN_MASK;
+  uint8_t target = can_frame_byte(frame, 2);
+  bool is_command =
+      (can_frame_byte(frame, 0) & ISOTP_PCI_MASK) == ISOTP_PCI_SF &&
+      sf_len >= 2 && sf_len < can_frame_dlc(frame);
+
+  if (!is_command || (target != FW_UPDATE_BROADCAST_ADDR &&
+                      target != matrix_settings.addr_id)) {
+    return;
+  }
 
-        } else if ((rx_data_can[0] == 0x82) && (rx_data_can[1] == 0x00) &&
-                   ((rx_data_can[5] & 0x80) != 0x80)) {
-          uint8_t buf2[6] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+  switch (can_frame_byte(frame, 1)) {
+  case FW_CMD_ENTER:
+    boot_request = FW_BOOT_REQUEST_MAGIC;
+    NVIC_SystemReset();
+    break;
 
-          can_send_answer((uint32_t)(matrix_settings.addr_id + 0x80), 6, buf2);
-        }
-      }
+  case FW_CMD_LABEL_SET: {
+    uint8_t code = can_frame_byte(frame, 3);
+    char msb = (char)can_frame_byte(frame, 4);
+    char lsb = (char)can_frame_byte(frame, 5);
+
+    bool is_label_ok = sf_len >= 5 && floor_labels_set(code, msb, lsb);
+    CAN_SendFwStatus(is_label_ok ? FW_RESULT_OK : FW_RESULT_BAD_LABEL);
+    break;
+  }
+
+  case FW_CMD_LABEL_COMMIT:
+  case FW_CMD_LABEL_CLEAR:
+    pending_label_cmd = can_frame_byte(frame, 1);
+    break;
+
+  case FW_CMD_DIAG:
+    if (sf_len >= 4) {
+      CAN_SendDiagInfo(can_frame_byte(frame, 3), can_frame_byte(frame, 4));
     }
+    break;
 
-    /* Полученные данные записываем в структуру msg */
-    if (rx_header.DLC == 6 && rx_data_can[0] == 0x81 &&
-        rx_data_can[1] == 0x00) {
+  case FW_CMD_RESET_CAUSE:
+    CAN_SendResetInfo();
+    break;
 
-      alive_cnt[0] = (alive_cnt[0] < UINT32_MAX) ? alive_cnt[0] + 1 : 0;
-      is_interface_connected = true;
-      is_data_received = true;
+  default:
+    break;
+  }
+}
 
-      msg.w0 = rx_data_can[2];
-      msg.w1 = rx_data_can[3];
-      msg.w2 = rx_data_can[4];
-      msg.w3 = rx_data_can[5];
+/**
+ * @brief  Запись надписей этажей во flash по команде от ПК.
+ * @note   Стирание страницы блокирует, поэтому выполняется в главном цикле, а
+ *         не в прерывании CAN RX. CRC и запись - на полной частоте ядра
+ *         (CLOCK_BURST_FLASH).
+ * @param  None
+ * @retval None
+ */
+void can_label_command_process(void) {
+  uint8_t cmd = pending_label_cmd;
+  if (cmd == 0) {
+    return;
+  }
+  pending_label_cmd = 0;
+
+  clock_governor_request(CLOCK_BURST_FLASH);
+  HAL_StatusTypeDef status = (cmd == FW_CMD_LABEL_COMMIT)
+                                 ? floor_labels_commit()
+                                 : floor_labels_clear();
+  clock_governor_release(CLOCK_BURST_FLASH);
+  CAN_SendFwStatus(status == HAL_OK ? FW_RESULT_OK : FW_RESULT_FLASH_ERROR);
+}
+#endif
+
+/**
+ * @brief  Разбор принятого кадра.
+ * @note   Для протоколов кадр передается декодеру протокола, кадр с данными
+ *         протокола регистрируется в мониторе связи (link_health), связь
+ *         проверяется таймером колеса таймеров. Строка кадра применяется на
+ *         общей для индикаторов группы границе строки развертки
+ *         (display_sync). Время приема и декодирования - по шкале времени
+ *         1 мкс (can_get_rx_timing()).
+ * @param  frame: Указатель на принятый кадр (mailbox FIFO0).
+ * @retval None
+ */
+static void CAN_DispatchFrame(const can_rx_frame_t *frame) {
+#if PROTOCOL_UIM_6100
+  // Кадр на текущей скорости (протокола или команда ПК): повторное
+  // автоопределение скорости не нужно
+  silence_start_ms = HAL_GetTick();
+  relearn_interval_ms = CAN_AUTOBAUD_RELEARN_MS;
+
+  if (can_frame_std_id(frame) == FW_UPDATE_HOST_ID) {
+    CAN_ProcessFwUpdateCommand(frame);
+    return;
+  }
+
+  uint32_t rx_us = timebase_now_us();
+
+  if (frame_decoder != NULL && frame_decoder(frame)) {
+    rx_timing.last_frame_us = rx_us;
+    rx_timing.decode_us = timebase_elapsed_us(rx_us);
+    if (rx_timing.decode_us > rx_timing.max_decode_us) {
+      rx_timing.max_decode_us = rx_timing.decode_us;
     }
 
+    link_health_frame_received(HAL_GetTick());
+    display_sync_frame_received(matrix_string);
+    scheduler_notify(TASK_PROTOCOL);
+    is_interface_connected = true;
+    is_data_received = true;
+
+    CAN_FinishRecovery();
+  }
+
 #elif TEST_MODE
 
-    if (rx_header.StdId == TEST_MODE_STD_ID) {
-      is_data_received = true;
-    }
+  if (can_frame_std_id(frame) == TEST_MODE_STD_ID) {
+    is_data_received = true;
+  }
 
 #endif
+}
+
+/**
+ * @brief  Обработка прерывания: получение данных по CAN.
+ *         Устанавливаем флаг is_data_received при получении данных.
+ * @note   Кадр разбирается прямо в mailbox FIFO0 (без HAL_CAN_GetRxMessage и
+ *         промежуточных буферов), затем mailbox освобождается.
+ * @param  hcan: Указатель на структуру CAN_HandleTypeDef.
+ * @retval None
+ */
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
+  const can_rx_frame_t *frame = &hcan->Instance->sFIFOMailBox[CAN_RX_FIFO0];
+
+  // Расширенные и удаленные кадры протоколами не используются
+  if ((frame->RIR & (CAN_RI0R_IDE | CAN_RI0R_RTR)) == 0) {
+    CAN_DispatchFrame(frame);
   }
+
+  SET_BIT(hcan->Instance->RF0R, CAN_RF0R_RFOM0);
 }
 
 /// Счетчик для контроля ошибок для CAN.
@@ -139,12 +444,45 @@ static volatile uint8_t cnt = 0;
 
 /**
  * @brief  Обработка прерывания для ошибок по CAN.
+ * @note   При bus-off запускается восстановление (can_recovery_process).
+ *         Накопленные коды ошибок HAL сбрасываются, чтобы следующий вызов
+ *         видел только новые ошибки.
  * @param  hcan: Указатель на структуру CAN_HandleTypeDef.
  * @retval None
  */
 void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan) {
   cnt = (cnt < UINT8_MAX) ? cnt + 1 : 0;
   uint32_t er = HAL_CAN_GetError(hcan);
+
+  if ((er & HAL_CAN_ERROR_BOF) != 0) {
+    CAN_EnterBusOff();
+  }
+
+  HAL_CAN_ResetError(hcan);
+}
+
+/**
+ * @brief  Установка фильтра, пропускающего все сообщения (для TEST_MODE и
+ *         автоопределения скорости).
+ * @param  None
+ * @retval None
+ */
+static void CAN_SetFilterAcceptAll(void) {
+  CAN_FilterTypeDef canFilterConfig;
+
+  canFilterConfig.FilterBank = 0;
+  canFilterConfig.FilterMode = CAN_FILTERMODE_IDMASK;
+  canFilterConfig.FilterScale = CAN_FILTERSCALE_32BIT;
+  canFilterConfig.FilterIdHigh = 0x0000;
+  canFilterConfig.FilterIdLow = 0x0000;
+  canFilterConfig.FilterMaskIdHigh = 0x0000;
+  canFilterConfig.FilterMaskIdLow = 0x0000;
+  canFilterConfig.FilterFIFOAssignment = CAN_RX_FIFO0;
+  canFilterConfig.FilterActivation = ENABLE;
+  canFilterConfig.SlaveStartFilterBank = 14;
+  if (HAL_CAN_ConfigFilter(&hcan, &canFilterConfig) != HAL_OK) {
+    Error_Handler();
+  }
 }
 /* USER CODE END 0 */
 
@@ -161,17 +499,21 @@ void MX_CAN_Init(void) {
   /* USER CODE END CAN_Init 1 */
   hcan.Instance = CAN1;
 #if PROTOCOL_UIM_6100
-  hcan.Init.Prescaler = 10; // 200 kbit/s
+  hcan.Init.Prescaler = can_prescaler; // 200/125/250 kbit/s (can_set_bitrate)
   hcan.Init.Mode = CAN_MODE_NORMAL;
 #elif TEST_MODE
-  hcan.Init.Prescaler = 4;
+  hcan.Init.Prescaler = CAN_PRESCALER(500000);
   hcan.Init.Mode = CAN_MODE_LOOPBACK;
 #endif
   hcan.Init.SyncJumpWidth = CAN_SJW_1TQ;
-  hcan.Init.TimeSeg1 = CAN_BS1_13TQ;
-  hcan.Init.TimeSeg2 = CAN_BS2_2TQ;
+  hcan.Init.TimeSeg1 = CAN_TIME_SEG1; // См. CAN_TQ_PER_BIT (main.h)
+  hcan.Init.TimeSeg2 = CAN_TIME_SEG2;
   hcan.Init.TimeTriggeredMode = DISABLE;
+#if PROTOCOL_UIM_6100
+  hcan.Init.AutoBusOff = DISABLE; // Восстановление: can_recovery_process()
+#else
   hcan.Init.AutoBusOff = ENABLE;
+#endif
   hcan.Init.AutoWakeUp = DISABLE;
   hcan.Init.AutoRetransmission = ENABLE;
   hcan.Init.ReceiveFifoLocked = DISABLE;
@@ -182,21 +524,7 @@ void MX_CAN_Init(void) {
   }
 
 #if TEST_MODE
-  CAN_FilterTypeDef canFilterConfig;
-
-  canFilterConfig.FilterBank = 0;
-  canFilterConfig.FilterMode = CAN_FILTERMODE_IDMASK;
-  canFilterConfig.FilterScale = CAN_FILTERSCALE_32BIT;
-  canFilterConfig.FilterIdHigh = 0x0000;
-  canFilterConfig.FilterIdLow = 0x0000;
-  canFilterConfig.FilterMaskIdHigh = 0x0000;
-  canFilterConfig.FilterMaskIdLow = 0x0000;
-  canFilterConfig.FilterFIFOAssignment = CAN_RX_FIFO0;
-  canFilterConfig.FilterActivation = ENABLE;
-  canFilterConfig.SlaveStartFilterBank = 14;
-  if (HAL_CAN_ConfigFilter(&hcan, &canFilterConfig) != HAL_OK) {
-    Error_Handler();
-  }
+  CAN_SetFilterAcceptAll();
 #endif
 
   /* USER CODE BEGIN CAN_Init 2 */
@@ -229,11 +557,11 @@ void HAL_CAN_MspInit(CAN_HandleTypeDef *canHandle) {
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
     /* CAN1 interrupt Init */
-    HAL_NVIC_SetPriority(USB_HP_CAN1_TX_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(USB_HP_CAN1_TX_IRQn, IRQ_PRIORITY_CAN_SERVICE, 0);
     HAL_NVIC_EnableIRQ(USB_HP_CAN1_TX_IRQn);
-    HAL_NVIC_SetPriority(USB_LP_CAN1_RX0_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(USB_LP_CAN1_RX0_IRQn, IRQ_PRIORITY_PROTOCOL_RX, 0);
     HAL_NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
-    HAL_NVIC_SetPriority(CAN1_SCE_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(CAN1_SCE_IRQn, IRQ_PRIORITY_CAN_SERVICE, 0);
     HAL_NVIC_EnableIRQ(CAN1_SCE_IRQn);
     /* USER CODE BEGIN CAN1_MspInit 1 */
 
@@ -292,13 +620,14 @@ static void set_frame(uint32_t stdId) {
 
 /**
  * @brief  Установка фильтра для сообщений по ID.
- * @param  id: Стандартный ID сообщения.
+ * @param  bank: Номер банка фильтра.
+ * @param  id:   Стандартный ID сообщения.
  * @retval None
  */
-static void CAN_SetFilterId(uint8_t id) {
+static void CAN_SetFilterId(uint32_t bank, uint16_t id) {
   CAN_FilterTypeDef canFilterConfig;
 
-  canFilterConfig.FilterBank = 0;
+  canFilterConfig.FilterBank = bank;
   canFilterConfig.FilterMode = CAN_FILTERMODE_IDLIST;
   canFilterConfig.FilterScale = CAN_FILTERSCALE_32BIT;
 
@@ -316,6 +645,152 @@ static void CAN_SetFilterId(uint8_t id) {
   }
 }
 
+/**
+ * @brief  Установка декодера протокола для принятых кадров.
+ * @param  decoder: Декодер протокола, NULL - кадры не разбираются.
+ * @retval None
+ */
+void can_set_frame_decoder(can_frame_decoder_t decoder) {
+  frame_decoder = decoder;
+}
+
+/**
+ * @brief  Установка скорости CAN для последующего вызова MX_CAN_Init().
+ * @param  bitrate: Индекс скорости can_bitrate_t. Для CAN_BITRATE_UNKNOWN и
+ *                  недопустимых значений устанавливается CAN_BITRATE_200_KBIT.
+ * @retval None
+ */
+void can_set_bitrate(uint8_t bitrate) {
+  if (bitrate >= CAN_BITRATE_COUNT) {
+    bitrate = CAN_BITRATE_200_KBIT;
+  }
+  can_prescaler = can_prescalers[bitrate];
+}
+
+/**
+ * @brief  Получение кода последней ошибки CAN (поле LEC регистра ESR).
+ * @param  None
+ * @retval 0 - нет ошибки, 1..6 - ошибка на шине, 7 - код сброшен программно.
+ */
+static uint8_t CAN_GetLastErrorCode(void) {
+  return (hcan.Instance->ESR & CAN_ESR_LEC) >> CAN_ESR_LEC_Pos;
+}
+
+/**
+ * @brief  Запуск прослушивания шины на скорости ab->bitrate (режим silent).
+ * @note   Прерывания CAN не используются: кадры и ошибки проверяются в
+ *         CAN_AutobaudStep().
+ * @param  ab: Указатель на состояние автоопределения.
+ * @retval true, если bxCAN запущен на этой скорости.
+ */
+static bool CAN_ListenStart(can_autobaud_t *ab) {
+  ab->valid_frames = 0;
+  ab->start_ms = HAL_GetTick();
+
+  HAL_CAN_Stop(&hcan);
+  hcan.Init.Prescaler = can_prescalers[ab->bitrate];
+  hcan.Init.Mode = CAN_MODE_SILENT;
+  if (HAL_CAN_Init(&hcan) != HAL_OK) {
+    return false;
+  }
+  CAN_SetFilterAcceptAll();
+  HAL_CAN_Start(&hcan);
+
+  // LEC = 7: код устанавливается только программно, изменится при ошибке
+  hcan.Instance->ESR = CAN_ESR_LEC;
+  return true;
+}
+
+/**
+ * @brief  Начало автоопределения скорости: прослушивание первой скорости.
+ * @param  ab:         Указатель на состояние автоопределения.
+ * @param  timeout_ms: Максимальное время автоопределения в мс.
+ * @retval None
+ */
+static void CAN_AutobaudStart(can_autobaud_t *ab, uint32_t timeout_ms) {
+  ab->bitrate = 0;
+  ab->deadline_ms = HAL_GetTick() + timeout_ms;
+  CAN_ListenStart(ab);
+}
+
+/**
+ * @brief  Шаг автоопределения скорости (не блокирует).
+ * @note   При неверной скорости контроллер фиксирует ошибки формата или
+ *         бит-стаффинга (LEC 1..6), тогда скорость сразу отбрасывается, как
+ *         и после CAN_AUTOBAUD_LISTEN_MS без CAN_AUTOBAUD_FRAMES_TO_LOCK
+ *         кадров. Скорости перебираются по кругу до ab->deadline_ms: срок
+ *         проверяется на каждом шаге, а не после перебора всех скоростей.
+ * @param  ab: Указатель на состояние автоопределения.
+ * @retval Индекс найденной скорости, CAN_BITRATE_UNKNOWN (срок истек) или
+ *         CAN_AUTOBAUD_PENDING (прослушивание продолжается).
+ */
+static uint8_t CAN_AutobaudStep(can_autobaud_t *ab) {
+  CAN_RxHeaderTypeDef header;
+  uint8_t data[8];
+  uint32_t now_ms = HAL_GetTick();
+
+  if ((int32_t)(now_ms - ab->deadline_ms) >= 0) {
+    return CAN_BITRATE_UNKNOWN;
+  }
+
+  uint8_t lec = CAN_GetLastErrorCode();
+  bool is_rejected = (lec != 0 && lec != 7) ||
+                     now_ms - ab->start_ms >= CAN_AUTOBAUD_LISTEN_MS;
+
+  if (!is_rejected) {
+    while (HAL_CAN_GetRxFifoFillLevel(&hcan, CAN_RX_FIFO0) > 0) {
+      if (HAL_CAN_GetRxMessage(&hcan, CAN_RX_FIFO0, &header, data) == HAL_OK) {
+        ab->valid_frames++;
+      }
+    }
+    return ab->valid_frames >= CAN_AUTOBAUD_FRAMES_TO_LOCK
+               ? ab->bitrate
+               : CAN_AUTOBAUD_PENDING;
+  }
+
+  ab->bitrate = (ab->bitrate + 1) % CAN_BITRATE_COUNT;
+  return CAN_ListenStart(ab) ? CAN_AUTOBAUD_PENDING : CAN_BITRATE_UNKNOWN;
+}
+
+/**
+ * @brief  Завершение автоопределения скорости: bxCAN остановлен, режим
+ *         NORMAL для следующего MX_CAN_Init().
+ * @param  None
+ * @retval None
+ */
+static void CAN_AutobaudFinish(void) {
+  HAL_CAN_Stop(&hcan);
+  hcan.Init.Mode = CAN_MODE_NORMAL;
+}
+
+/**
+ * @brief  Автоопределение скорости CAN в режиме прослушивания (silent).
+ * @note   Перебираются скорости can_bitrate_t, на каждой шина слушается
+ *         CAN_AUTOBAUD_LISTEN_MS. Скорость принимается, если получено
+ *         CAN_AUTOBAUD_FRAMES_TO_LOCK кадров без ошибок. Общее время
+ *         ограничено CAN_AUTOBAUD_TIMEOUT_MS (проверяется на каждом шаге).
+ * @param  idle_callback: Функция, вызываемая в цикле ожидания (например,
+ *                        отображение строки на матрице), может быть NULL.
+ * @retval Индекс найденной скорости или CAN_BITRATE_UNKNOWN.
+ */
+uint8_t can_autobaud(void (*idle_callback)(void)) {
+  can_autobaud_t ab;
+  uint8_t found_bitrate;
+
+  // Заполнение hcan.Init общими параметрами (кванты, режимы)
+  MX_CAN_Init();
+
+  CAN_AutobaudStart(&ab, CAN_AUTOBAUD_TIMEOUT_MS);
+  while ((found_bitrate = CAN_AutobaudStep(&ab)) == CAN_AUTOBAUD_PENDING) {
+    if (idle_callback != NULL) {
+      idle_callback();
+    }
+  }
+
+  CAN_AutobaudFinish();
+  return found_bitrate;
+}
+
 /**
  * @brief  Запуск интерфейса CAN.
  * @note   Установка фильтра для ID, включение нотификаций для колбека.
@@ -324,7 +799,10 @@ static void CAN_SetFilterId(uint8_t id) {
  */
 void start_can(CAN_HandleTypeDef *hcan, uint32_t stdId) {
 #if PROTOCOL_UIM_6100
-  CAN_SetFilterId(stdId);
+  CAN_SetFilterId(0, stdId);
+  CAN_SetFilterId(1, FW_UPDATE_HOST_ID); // Команда запуска загрузчика
+  relearn_std_id = stdId;
+  silence_start_ms = HAL_GetTick();
 #endif
 
   HAL_CAN_Start(hcan);
@@ -335,10 +813,77 @@ void start_can(CAN_HandleTypeDef *hcan, uint32_t stdId) {
 
 /**
  * @brief  Завершение работы CAN.
+ * @note   Прерванное повторное автоопределение скорости не изменяет
+ *         скорость can_set_bitrate().
  * @param  hcan: Указатель на структуру CAN_HandleTypeDef.
  * @retval None
  */
-void stop_can(CAN_HandleTypeDef *hcan) { HAL_CAN_Stop(hcan); }
+void stop_can(CAN_HandleTypeDef *hcan) {
+#if PROTOCOL_UIM_6100
+  if (is_relearning) {
+    is_relearning = false;
+    CAN_AutobaudFinish();
+    MX_CAN_Init();
+  }
+#endif
+  HAL_CAN_Stop(hcan);
+}
+
+#if PROTOCOL_UIM_6100
+/**
+ * @brief  Повторное автоопределение скорости после потери связи (не
+ *         блокирует, шаг за проход главного цикла).
+ * @note   1. Запускается, если кадров нет relearn_interval_ms и шина не в
+ *            bus-off: скорость сети могла измениться после записи во
+ *            flash. Прием на время автоопределения (не дольше
+ *            CAN_AUTOBAUD_TIMEOUT_MS) останавливается;
+ *         2. Найденная скорость сохраняется, если отличается от сохраненной.
+ *            Если скорость не найдена, прием продолжается на сохраненной
+ *            скорости;
+ *         3. После каждой попытки интервал удваивается (не больше
+ *            CAN_AUTOBAUD_RELEARN_MAX_MS): на молчащей шине прием не
+ *            прерывается каждые CAN_AUTOBAUD_RELEARN_MS. Принятый кадр
+ *            сбрасывает интервал.
+ * @param  None
+ * @retval None
+ */
+void can_relearn_process(void) {
+  if (!is_relearning) {
+    if (can_is_recovering() ||
+        HAL_GetTick() - silence_start_ms < relearn_interval_ms) {
+      return;
+    }
+    is_relearning = true;
+    HAL_CAN_DeactivateNotification(&hcan, CAN_IT_RX_FIFO0_MSG_PENDING |
+                                              CAN_IT_ERROR | CAN_IT_BUSOFF |
+                                              CAN_IT_LAST_ERROR_CODE);
+    CAN_AutobaudStart(&relearn, CAN_AUTOBAUD_TIMEOUT_MS);
+    return;
+  }
+
+  uint8_t found_bitrate = CAN_AutobaudStep(&relearn);
+  if (found_bitrate == CAN_AUTOBAUD_PENDING) {
+    return;
+  }
+
+  is_relearning = false;
+  CAN_AutobaudFinish();
+
+  if (found_bitrate != CAN_BITRATE_UNKNOWN &&
+      found_bitrate != matrix_settings.can_bitrate) {
+    matrix_settings.can_bitrate = found_bitrate;
+    overwrite_settings(&matrix_settings);
+  }
+
+  if (relearn_interval_ms < CAN_AUTOBAUD_RELEARN_MAX_MS) {
+    relearn_interval_ms *= 2;
+  }
+
+  can_set_bitrate(matrix_settings.can_bitrate);
+  MX_CAN_Init();
+  start_can(&hcan, relearn_std_id);
+}
+#endif
 
 /**
  * @brief  Отправка данных по CAN (для TEST_MODE, loopback).
@@ -362,20 +907,73 @@ void CAN_TxData(uint32_t stdId) {
 }
 
 /**
- * @brief  Обработка данных, полученных по CAN.
- * @note   Если получены данные от станции управления (СУЛ), то начать обработку
- *         по протоколу.
+ * @brief  Проверка и сброс флага данных, полученных по CAN.
+ * @note   Если получены данные от станции управления (СУЛ), протокол начинает
+ *         обработку событий кадров.
  * @param  None
- * @retval None
+ * @retval true, если с прошлого вызова принят кадр с данными протокола.
  */
-void process_data_from_can() {
+bool can_take_received_data() {
+  if (!is_data_received) {
+    return false;
+  }
 
-  if (is_data_received) {
-    is_data_received = false;
+  is_data_received = false;
+  return true;
+}
 
-#if PROTOCOL_UIM_6100
-    process_data_uim(&msg);
-#endif
+/**
+ * @brief  Обработка восстановления после bus-off (вызывается в главном цикле).
+ * @note   По истечении задержки recovery_backoff_ms запрашивает выход из
+ *         bus-off. Восстановление завершается первым корректным кадром
+ *         протокола (HAL_CAN_RxFifo0MsgPendingCallback).
+ * @param  None
+ * @retval true, если идет восстановление и нужно отображать последний этаж;
+ *         false - нормальная работа или восстановление длится дольше
+ *         CAN_RECOVERY_HOLD_FLOOR_MS (отображается "c--" по общему правилу).
+ */
+bool can_recovery_process() {
+  if (recovery_state == CAN_RECOVERY_IDLE) {
+    return false;
+  }
+
+  uint32_t now_ms = HAL_GetTick();
+
+  if (recovery_state == CAN_RECOVERY_BUS_OFF &&
+      (int32_t)(now_ms - recovery_attempt_ms) >= 0) {
+    recovery_state = CAN_RECOVERY_RESYNC;
+    CAN_RequestBusOffRecovery();
   }
+
+  return now_ms - bus_off_start_ms < CAN_RECOVERY_HOLD_FLOOR_MS;
+}
+
+/**
+ * @brief  Проверка, идет ли восстановление после bus-off.
+ * @param  None
+ * @retval true, если шина в bus-off или ожидается первый кадр после него.
+ */
+bool can_is_recovering() { return recovery_state != CAN_RECOVERY_IDLE; }
+
+/**
+ * @brief  Получение статистики восстановления после bus-off.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void can_get_recovery_stats(can_recovery_stats_t *stats) {
+  __disable_irq();
+  *stats = recovery_stats;
+  __enable_irq();
+}
+
+/**
+ * @brief  Получение меток времени кадров протокола.
+ * @param  timing: Указатель на структуру для копирования меток.
+ * @retval None
+ */
+void can_get_rx_timing(can_rx_timing_t *timing) {
+  __disable_irq();
+  *timing = rx_timing;
+  __enable_irq();
 }
 /* USER CODE END 1 */
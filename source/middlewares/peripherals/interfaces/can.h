@@ -29,6 +29,7 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
+#include <stdbool.h>
 #include <stdint.h>
 /* USER CODE END Includes */
 
@@ -36,12 +37,132 @@ extern CAN_HandleTypeDef hcan;
 
 /* USER CODE BEGIN Private defines */
 #define TEST_MODE_STD_ID 0x0378 ///< ID сообщения для CAN в TEST_MODE
+
+#define CAN_BITRATE_UNKNOWN                                                    \
+  0xFF ///< Скорость CAN не определена (стертая flash-память)
+
+/**
+ * Поддерживаемые скорости CAN (индексы хранятся во flash-памяти, см.
+ * settings_t). Порядок определяет порядок перебора при автоопределении.
+ */
+typedef enum {
+  CAN_BITRATE_200_KBIT = 0, // УИМ6100 (по умолчанию)
+  CAN_BITRATE_125_KBIT,
+  CAN_BITRATE_250_KBIT,
+  CAN_BITRATE_COUNT
+} can_bitrate_t;
+
+/**
+ * Статистика восстановления после bus-off.
+ */
+typedef struct {
+  uint32_t bus_off_count;    // Кол-во переходов в bus-off
+  uint32_t last_recovery_ms; // Время последнего восстановления в мс
+  uint32_t max_recovery_ms;  // Максимальное время восстановления в мс
+} can_recovery_stats_t;
+
+/**
+ * Метки времени кадров протокола (шкала времени 1 мкс, timebase.h).
+ */
+typedef struct {
+  uint32_t last_frame_us; // Время приема последнего кадра протокола
+  uint32_t decode_us;     // Время декодирования последнего кадра в мкс
+  uint32_t max_decode_us; // Максимальное время декодирования кадра в мкс
+} can_rx_timing_t;
+
+/**
+ * Принятый кадр - mailbox FIFO0 (регистры RIR, RDTR, RDLR, RDHR). Декодер
+ * читает поля прямо из регистров, без копирования кадра в буфер.
+ */
+typedef CAN_FIFOMailBox_TypeDef can_rx_frame_t;
+
+/**
+ * Декодер протокола: разбирает кадр и обновляет состояние протокола.
+ * Возвращает true для кадра с данными протокола (кадр подтверждает
+ * подключение интерфейса).
+ */
+typedef bool (*can_frame_decoder_t)(const can_rx_frame_t *frame);
+
+/**
+ * @brief  Стандартный ID принятого кадра.
+ * @param  frame: Указатель на принятый кадр.
+ * @retval ID кадра.
+ */
+static inline uint32_t can_frame_std_id(const can_rx_frame_t *frame) {
+  return (frame->RIR & CAN_RI0R_STID) >> CAN_RI0R_STID_Pos;
+}
+
+/**
+ * @brief  Длина данных принятого кадра.
+ * @param  frame: Указатель на принятый кадр.
+ * @retval DLC кадра.
+ */
+static inline uint8_t can_frame_dlc(const can_rx_frame_t *frame) {
+  return (uint8_t)((frame->RDTR & CAN_RDT0R_DLC) >> CAN_RDT0R_DLC_Pos);
+}
+
+/**
+ * @brief  Байт данных принятого кадра.
+ * @param  frame: Указатель на принятый кадр.
+ * @param  index: Номер байта (0..7).
+ * @retval Значение байта.
+ */
+static inline uint8_t can_frame_byte(const can_rx_frame_t *frame,
+                                     uint8_t index) {
+  uint32_t data = (index < 4) ? frame->RDLR : frame->RDHR;
+  return (uint8_t)(data >> ((index & 0x03) * 8));
+}
 /* USER CODE END Private defines */
 
 void MX_CAN_Init(void);
 
 /* USER CODE BEGIN Prototypes */
 
+/**
+ * @brief  Установка декодера протокола для принятых кадров.
+ * @param  decoder: Декодер протокола, NULL - кадры не разбираются.
+ * @retval None
+ */
+void can_set_frame_decoder(can_frame_decoder_t decoder);
+
+/**
+ * @brief Отправка сообщений-ответов по CAN для PROTOCOL_UIM_6100.
+ *
+ * @param stdId:  Адрес, на который отправляется ответ.
+ * @param dlc:    Размер сообщения в байтах.
+ * @param buffer: Указатель на буфер с данными для ответа.
+ */
+void can_send_answer(uint32_t stdId, uint8_t dlc, uint8_t *buffer);
+
+/**
+ * @brief  Запись надписей этажей во flash по команде от ПК
+ *         (FW_CMD_LABEL_COMMIT, FW_CMD_LABEL_CLEAR), вызывается в главном
+ *         цикле для PROTOCOL_UIM_6100.
+ * @param  None
+ * @retval None
+ */
+void can_label_command_process(void);
+
+/**
+ * @brief  Установка скорости CAN для последующего вызова MX_CAN_Init().
+ * @param  bitrate: Индекс скорости can_bitrate_t. Для CAN_BITRATE_UNKNOWN и
+ *                  недопустимых значений устанавливается CAN_BITRATE_200_KBIT.
+ * @retval None
+ */
+void can_set_bitrate(uint8_t bitrate);
+
+/**
+ * @brief  Автоопределение скорости CAN в режиме прослушивания (silent).
+ * @note   Перебираются скорости can_bitrate_t, на каждой шина слушается
+ *         CAN_AUTOBAUD_LISTEN_MS. Скорость принимается, если получено
+ *         CAN_AUTOBAUD_FRAMES_TO_LOCK кадров без ошибок. Общее время
+ *         ограничено CAN_AUTOBAUD_TIMEOUT_MS (проверяется на каждом шаге).
+ * @param  idle_callback: Функция, вызываемая в цикле ожидания (например,
+ *                        отображение строки на матрице), может быть NULL.
+ * @retval Индекс найденной скорости или CAN_BITRATE_UNKNOWN.
+ */
+uint8_t can_autobaud(void (*idle_callback)(void));
+
 /**
  * @brief  Запуск интерфейса CAN.
  * @note   Установка фильтра для ID, включение нотификаций для колбека.
@@ -66,13 +187,57 @@ void stop_can(CAN_HandleTypeDef *hcan);
 void CAN_TxData(uint32_t stdId);
 
 /**
- * @brief  Обработка данных, полученных по CAN.
- * @note   Если получены данные от станции управления (СУЛ), то начать обработку
- *         по протоколу.
+ * @brief  Проверка и сброс флага данных, полученных по CAN.
+ * @note   Если получены данные от станции управления (СУЛ), протокол начинает
+ *         обработку событий кадров.
+ * @param  None
+ * @retval true, если с прошлого вызова принят кадр с данными протокола.
+ */
+bool can_take_received_data();
+
+/**
+ * @brief  Повторное автоопределение скорости после потери связи (не
+ *         блокирует, шаг за проход главного цикла).
+ * @note   Запускается, если кадров нет CAN_AUTOBAUD_RELEARN_MS, затем с
+ *         удвоением интервала до CAN_AUTOBAUD_RELEARN_MAX_MS (принятый кадр
+ *         сбрасывает интервал). Найденная скорость сохраняется во flash.
  * @param  None
  * @retval None
  */
-void process_data_from_can();
+void can_relearn_process(void);
+
+/**
+ * @brief  Обработка восстановления после bus-off (вызывается в главном цикле).
+ * @note   По истечении задержки recovery_backoff_ms запрашивает выход из
+ *         bus-off. Восстановление завершается первым корректным кадром
+ *         протокола (HAL_CAN_RxFifo0MsgPendingCallback).
+ * @param  None
+ * @retval true, если идет восстановление и нужно отображать последний этаж;
+ *         false - нормальная работа или восстановление длится дольше
+ *         CAN_RECOVERY_HOLD_FLOOR_MS (отображается "c--" по общему правилу).
+ */
+bool can_recovery_process();
+
+/**
+ * @brief  Проверка, идет ли восстановление после bus-off.
+ * @param  None
+ * @retval true, если шина в bus-off или ожидается первый кадр после него.
+ */
+bool can_is_recovering();
+
+/**
+ * @brief  Получение статистики восстановления после bus-off.
+ * @param  stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void can_get_recovery_stats(can_recovery_stats_t *stats);
+
+/**
+ * @brief  Получение меток времени кадров протокола.
+ * @param  timing: Указатель на структуру для копирования меток.
+ * @retval None
+ */
+void can_get_rx_timing(can_rx_timing_t *timing);
 
 /* USER CODE END Prototypes */
 
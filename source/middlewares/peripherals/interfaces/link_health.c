@@ -0,0 +1,172 @@
+/**
+ * @file link_health.c
+ */
+#include "link_health.h"
+
+#define FIXED_POINT_SHIFT 4 ///< Дробная часть периода и джиттера (1/16 мс)
+#define PERIOD_EWMA_SHIFT 3 ///< Вес нового интервала в периоде (1/8)
+#define JITTER_EWMA_SHIFT 4 ///< Вес нового отклонения в джиттере (1/16)
+
+/// Время потери связи в мс, пока период кадров не определен.
+static uint32_t no_traffic_timeout_ms = 0;
+
+/// Время приема последнего кадра в мс.
+static volatile uint32_t last_frame_ms = 0;
+
+/// Ожидаемый период кадров в 1/16 мс (0 - еще не определен).
+static volatile uint32_t period_q4 = 0;
+
+/// Сумма интервалов для первичного определения периода в мс.
+static uint32_t learn_sum_ms = 0;
+
+/// Кол-во интервалов, накопленных в learn_sum_ms.
+static uint8_t learn_cnt = 0;
+
+/// Средний джиттер в 1/16 мс.
+static volatile uint32_t jitter_q4 = 0;
+
+/// Флаг наличия связи.
+static volatile bool is_link_up = true;
+
+/// Флаг приема хотя бы одного кадра после сброса (есть last_frame_ms кадра).
+static volatile bool has_last_frame = false;
+
+/// Статистика состояния связи (period_ms и jitter_ms заполняются при чтении).
+static volatile link_health_stats_t stats = {0, 0, 0, 0, 0};
+
+/**
+ * @brief  Расчет времени потери связи.
+ * @note   До определения периода используется no_traffic_timeout_ms, затем -
+ *         LINK_HEALTH_MISSED_PERIODS периодов, ограниченные снизу
+ *         LINK_HEALTH_MIN_TIMEOUT_MS и сверху no_traffic_timeout_ms.
+ * @param  None
+ * @retval Время потери связи в мс.
+ */
+static uint32_t get_loss_timeout_ms(void) {
+  if (period_q4 == 0) {
+    return no_traffic_timeout_ms;
+  }
+
+  uint32_t timeout_ms =
+      (period_q4 * LINK_HEALTH_MISSED_PERIODS) >> FIXED_POINT_SHIFT;
+
+  if (timeout_ms < LINK_HEALTH_MIN_TIMEOUT_MS) {
+    timeout_ms = LINK_HEALTH_MIN_TIMEOUT_MS;
+  }
+
+  if (timeout_ms > no_traffic_timeout_ms) {
+    timeout_ms = no_traffic_timeout_ms;
+  }
+
+  return timeout_ms;
+}
+
+/**
+ * @brief  Обновление периода и джиттера по интервалу между кадрами.
+ * @note   Первые LINK_HEALTH_LEARN_FRAMES интервалов усредняются, затем период
+ *         и джиттер сглаживаются скользящим средним. Интервалы после потери
+ *         связи не учитываются.
+ * @param  interval_ms: Интервал между двумя последними кадрами в мс.
+ * @retval None
+ */
+static void update_period(uint32_t interval_ms) {
+  if (period_q4 == 0) {
+    learn_sum_ms += interval_ms;
+    learn_cnt++;
+
+    if (learn_cnt >= LINK_HEALTH_LEARN_FRAMES) {
+      period_q4 = (learn_sum_ms << FIXED_POINT_SHIFT) / learn_cnt;
+      period_q4 = (period_q4 != 0) ? period_q4 : 1;
+    }
+    return;
+  }
+
+  int32_t deviation_q4 =
+      (int32_t)(interval_ms << FIXED_POINT_SHIFT) - (int32_t)period_q4;
+  uint32_t abs_deviation_q4 =
+      (deviation_q4 < 0) ? (uint32_t)-deviation_q4 : (uint32_t)deviation_q4;
+
+  jitter_q4 = jitter_q4 - (jitter_q4 >> JITTER_EWMA_SHIFT) +
+              (abs_deviation_q4 >> JITTER_EWMA_SHIFT);
+
+  uint32_t abs_deviation_ms = abs_deviation_q4 >> FIXED_POINT_SHIFT;
+  if (abs_deviation_ms > stats.max_jitter_ms) {
+    stats.max_jitter_ms = abs_deviation_ms;
+  }
+
+  int32_t new_period_q4 =
+      (int32_t)period_q4 + (deviation_q4 >> PERIOD_EWMA_SHIFT);
+  period_q4 = (new_period_q4 > 0) ? (uint32_t)new_period_q4 : 1;
+}
+
+/**
+ * @brief  Сброс монитора связи (при запуске интерфейса).
+ * @param  timeout_ms: Время потери связи в мс, пока период кадров не
+ *                     определен.
+ * @retval None
+ */
+void link_health_reset(uint32_t timeout_ms) {
+  __disable_irq();
+  no_traffic_timeout_ms = timeout_ms;
+  last_frame_ms = HAL_GetTick();
+  period_q4 = 0;
+  learn_sum_ms = 0;
+  learn_cnt = 0;
+  jitter_q4 = 0;
+  is_link_up = true;
+  has_last_frame = false;
+  __enable_irq();
+}
+
+/**
+ * @brief  Регистрация принятого кадра (вызывается из прерывания приема).
+ * @param  timestamp_ms: Время приема кадра в мс (HAL_GetTick).
+ * @retval None
+ */
+void link_health_frame_received(uint32_t timestamp_ms) {
+  uint32_t interval_ms = timestamp_ms - last_frame_ms;
+
+  if (is_link_up && has_last_frame && interval_ms < get_loss_timeout_ms()) {
+    update_period(interval_ms);
+  }
+
+  stats.frames++;
+  last_frame_ms = timestamp_ms;
+  has_last_frame = true;
+  is_link_up = true;
+}
+
+/**
+ * @brief  Проверка связи (вызывается из колеса таймеров каждые
+ *         LINK_HEALTH_CHECK_PERIOD_MS мс).
+ * @note   Связь потеряна, если кадров нет дольше LINK_HEALTH_MISSED_PERIODS
+ *         ожидаемых периодов (но не меньше LINK_HEALTH_MIN_TIMEOUT_MS).
+ * @param  now_ms: Текущее время в мс (HAL_GetTick).
+ * @retval true, если связь есть; false - связь потеряна.
+ */
+bool link_health_check(uint32_t now_ms) {
+  if (!is_link_up) {
+    return false;
+  }
+
+  if (now_ms - last_frame_ms >= get_loss_timeout_ms()) {
+    is_link_up = false;
+    stats.losses++;
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief  Получение статистики состояния связи.
+ * @param  link_stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void link_health_get_stats(link_health_stats_t *link_stats) {
+  __disable_irq();
+  *link_stats = stats;
+  link_stats->period_ms = period_q4 >> FIXED_POINT_SHIFT;
+  link_stats->jitter_ms = jitter_q4 >> FIXED_POINT_SHIFT;
+  __enable_irq();
+}
@@ -0,0 +1,66 @@
+/**
+ * @file    link_health.h
+ * @brief   Этот файл содержит прототипы функций для файла link_health.c
+ */
+#ifndef __LINK_HEALTH_H__
+#define __LINK_HEALTH_H__
+
+#include "main.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LINK_HEALTH_MISSED_PERIODS                                             \
+  3 ///< Кол-во пропущенных периодов, после которого связь считается потерянной
+#define LINK_HEALTH_MIN_TIMEOUT_MS                                             \
+  50 ///< Минимальное время потери связи в мс (защита от джиттера при малом
+     ///< периоде кадров)
+#define LINK_HEALTH_LEARN_FRAMES                                               \
+  4 ///< Кол-во интервалов для первичного определения периода кадров
+#define LINK_HEALTH_CHECK_PERIOD_MS                                            \
+  LINK_HEALTH_MIN_TIMEOUT_MS ///< Период проверки связи (link_health_check())
+
+/**
+ * Статистика состояния связи.
+ */
+typedef struct {
+  uint32_t frames;        // Кол-во принятых кадров
+  uint32_t period_ms;     // Ожидаемый период кадров в мс (0 - не определен)
+  uint32_t jitter_ms;     // Средний джиттер (отклонение интервала от периода)
+  uint32_t max_jitter_ms; // Максимальный джиттер в мс
+  uint32_t losses;        // Кол-во потерь связи
+} link_health_stats_t;
+
+/**
+ * @brief  Сброс монитора связи (при запуске интерфейса).
+ * @param  timeout_ms: Время потери связи в мс, пока период кадров не
+ *                     определен.
+ * @retval None
+ */
+void link_health_reset(uint32_t timeout_ms);
+
+/**
+ * @brief  Регистрация принятого кадра (вызывается из прерывания приема).
+ * @param  timestamp_ms: Время приема кадра в мс (HAL_GetTick).
+ * @retval None
+ */
+void link_health_frame_received(uint32_t timestamp_ms);
+
+/**
+ * @brief  Проверка связи (вызывается из колеса таймеров каждые
+ *         LINK_HEALTH_CHECK_PERIOD_MS мс).
+ * @note   Связь потеряна, если кадров нет дольше LINK_HEALTH_MISSED_PERIODS
+ *         ожидаемых периодов (но не меньше LINK_HEALTH_MIN_TIMEOUT_MS).
+ * @param  now_ms: Текущее время в мс (HAL_GetTick).
+ * @retval true, если связь есть; false - связь потеряна.
+ */
+bool link_health_check(uint32_t now_ms);
+
+/**
+ * @brief  Получение статистики состояния связи.
+ * @param  link_stats: Указатель на структуру для копирования статистики.
+ * @retval None
+ */
+void link_health_get_stats(link_health_stats_t *link_stats);
+
+#endif /* __LINK_HEALTH_H__ */
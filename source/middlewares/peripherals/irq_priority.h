@@ -0,0 +1,40 @@
+/**
+ * @file    irq_priority.h
+ * @brief   Этот файл содержит карту приоритетов прерываний (NVIC).
+ */
+#ifndef __IRQ_PRIORITY_H__
+#define __IRQ_PRIORITY_H__
+
+/**
+ * Группировка NVIC: 4 бита - приоритет вытеснения (0..15), подприоритетов
+ * нет. Прерывание вытесняет только прерывания с большим номером приоритета,
+ * прерывания одного уровня выполняются по очереди.
+ *
+ * Порядок: развертка > прием протокола > звук > кнопки. Развертка не
+ * вытесняется ничем, поэтому граница строки не смещается при приеме кадров.
+ * Приоритеты также заданы в CubeMX/dot_indicator.ioc.
+ */
+#define IRQ_PRIORITY_GROUP NVIC_PRIORITYGROUP_4
+
+/// TIM4: граница строки развертки (1 мс).
+#define IRQ_PRIORITY_SCAN 0
+
+/// CAN RX0, TIM1 CC (короткий таймер 1 мкс колеса таймеров).
+#define IRQ_PRIORITY_PROTOCOL_RX 1
+
+/// CAN TX и SCE (завершение передачи, ошибки и bus-off).
+#define IRQ_PRIORITY_CAN_SERVICE 2
+
+/// TIM2: ШИМ пассивного бузера.
+#define IRQ_PRIORITY_SOUND 3
+
+/// EXTI15_10: кнопки меню.
+#define IRQ_PRIORITY_BUTTONS 4
+
+/*
+ * SysTick (HAL_GetTick(), колесо таймеров) - TICK_INT_PRIORITY (15, ниже
+ * всех, stm32f1xx_hal_conf.h): колбеки колеса таймеров не задерживают
+ * прерывания выше. HAL_GetTick() в прерываниях выше может отставать на 1 мс.
+ */
+
+#endif /* __IRQ_PRIORITY_H__ */
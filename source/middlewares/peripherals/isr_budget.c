@@ -0,0 +1,107 @@
+/**
+ * @file isr_budget.c
+ */
+#include "isr_budget.h"
+
+#if ISR_BUDGET_CHECK
+
+#include "main.h"
+#include "timebase.h"
+
+/// Бюджет обработчика в мкс (индекс - isr_id_t).
+static const uint16_t budget_us[ISR_ID_COUNT] = {
+    [ISR_ID_SCAN] = 20,
+    [ISR_ID_CAN_RX] = 60,
+    [ISR_ID_TIM1_CC] = 20,
+    [ISR_ID_CAN_TX] = 20,
+    [ISR_ID_CAN_SCE] = 40,
+    [ISR_ID_SOUND] = 20,
+    [ISR_ID_BUTTONS] = 20,
+    [ISR_ID_TICK] = 100,
+};
+
+/// Максимальное время выполнения обработчика в мкс (индекс - isr_id_t).
+static volatile uint32_t max_us[ISR_ID_COUNT];
+
+/// Сумма собственного времени завершенных обработчиков в мкс.
+static volatile uint32_t total_us = 0;
+
+/// Обработчик, превысивший бюджет (для отладчика), ISR_ID_COUNT - нет.
+static volatile isr_id_t overrun_id = ISR_ID_COUNT;
+
+/// Время выполнения обработчика, превысившего бюджет, в мкс.
+static volatile uint32_t overrun_us = 0;
+
+/**
+ * @brief  Подготовка измерения: остановка TIM1 и TIM3 (шкала времени) при
+ *         остановке ядра отладчиком, чтобы точка останова в обработчике не
+ *         считалась превышением бюджета.
+ * @param  None
+ * @retval None
+ */
+void isr_budget_init(void) {
+  __HAL_DBGMCU_FREEZE_TIM1();
+  __HAL_DBGMCU_FREEZE_TIM3();
+}
+
+/**
+ * @brief  Начало измерения обработчика.
+ * @param  frame: Указатель на начало измерения.
+ * @retval None
+ */
+void isr_budget_enter(isr_budget_frame_t *frame) {
+  __disable_irq();
+  frame->start_us = timebase_now_us();
+  frame->nested_us = total_us;
+  __enable_irq();
+}
+
+/**
+ * @brief  Остановка при превышении бюджета: точка останова, если подключен
+ *         отладчик, иначе Error_Handler().
+ * @param  id:         Обработчик isr_id_t.
+ * @param  elapsed_us: Время выполнения обработчика в мкс.
+ * @retval None
+ */
+static void trap_overrun(isr_id_t id, uint32_t elapsed_us) {
+  overrun_id = id;
+  overrun_us = elapsed_us;
+  if (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) {
+    __BKPT(0);
+  }
+  Error_Handler();
+}
+
+/**
+ * @brief  Конец измерения обработчика: обновление максимума, остановка при
+ *         превышении бюджета.
+ * @note   Собственное время - время от начала до конца обработчика без
+ *         вложенных прерываний (вытеснивших его): вложенный обработчик
+ *         добавляет свое собственное время к total_us.
+ * @param  frame: Указатель на начало измерения.
+ * @param  id:    Обработчик isr_id_t.
+ * @retval None
+ */
+void isr_budget_exit(const isr_budget_frame_t *frame, isr_id_t id) {
+  __disable_irq();
+  uint32_t elapsed_us = timebase_now_us() - frame->start_us;
+  elapsed_us -= total_us - frame->nested_us;
+  total_us += elapsed_us;
+  __enable_irq();
+
+  if (elapsed_us > max_us[id]) {
+    max_us[id] = elapsed_us;
+  }
+  if (elapsed_us > budget_us[id]) {
+    trap_overrun(id, elapsed_us);
+  }
+}
+
+/**
+ * @brief  Максимальное время выполнения обработчика с момента запуска.
+ * @param  id: Обработчик isr_id_t.
+ * @retval Время в мкс (без вложенных прерываний).
+ */
+uint32_t isr_budget_get_max_us(isr_id_t id) { return max_us[id]; }
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file    isr_budget.h
+ * @brief   Этот файл содержит прототипы функций для файла isr_budget.c
+ */
+#ifndef __ISR_BUDGET_H__
+#define __ISR_BUDGET_H__
+
+#include <stdint.h>
+
+/// Обработчики прерываний, время выполнения которых измеряется.
+typedef enum {
+  ISR_ID_SCAN,     // TIM4: граница строки развертки
+  ISR_ID_CAN_RX,   // CAN RX0: прием кадра
+  ISR_ID_TIM1_CC,  // TIM1 CC: короткий таймер 1 мкс
+  ISR_ID_CAN_TX,   // CAN TX: завершение передачи
+  ISR_ID_CAN_SCE,  // CAN SCE: ошибки и bus-off
+  ISR_ID_SOUND,    // TIM2: ШИМ пассивного бузера
+  ISR_ID_BUTTONS,  // EXTI15_10: кнопки
+  ISR_ID_TICK,     // SysTick: HAL_GetTick(), колесо таймеров
+  ISR_ID_COUNT
+} isr_id_t;
+
+#if ISR_BUDGET_CHECK
+
+/// Начало измерения обработчика (локальная переменная обработчика).
+typedef struct {
+  uint32_t start_us;  // Начало обработчика (timebase_now_us())
+  uint32_t nested_us; // Сумма времени обработчиков к началу
+} isr_budget_frame_t;
+
+/**
+ * @brief  Начало измерения: первая строка обработчика (USER CODE ... 0).
+ */
+#define ISR_BUDGET_ENTER()                                                     \
+  isr_budget_frame_t isr_budget_frame;                                         \
+  isr_budget_enter(&isr_budget_frame)
+
+/**
+ * @brief  Конец измерения: последняя строка обработчика (USER CODE ... 1).
+ * @param  id: Обработчик isr_id_t.
+ */
+#define ISR_BUDGET_EXIT(id) isr_budget_exit(&isr_budget_frame, (id))
+
+/**
+ * @brief  Подготовка измерения: остановка TIM1 и TIM3 (шкала времени) при
+ *         остановке ядра отладчиком, чтобы точка останова в обработчике не
+ *         считалась превышением бюджета.
+ * @param  None
+ * @retval None
+ */
+void isr_budget_init(void);
+
+/**
+ * @brief  Начало измерения обработчика.
+ * @param  frame: Указатель на начало измерения.
+ * @retval None
+ */
+void isr_budget_enter(isr_budget_frame_t *frame);
+
+/**
+ * @brief  Конец измерения обработчика: обновление максимума, остановка при
+ *         превышении бюджета.
+ * @param  frame: Указатель на начало измерения.
+ * @param  id:    Обработчик isr_id_t.
+ * @retval None
+ */
+void isr_budget_exit(const isr_budget_frame_t *frame, isr_id_t id);
+
+/**
+ * @brief  Максимальное время выполнения обработчика с момента запуска.
+ * @param  id: Обработчик isr_id_t.
+ * @retval Время в мкс (без вложенных прерываний).
+ */
+uint32_t isr_budget_get_max_us(isr_id_t id);
+
+#else
+
+#define ISR_BUDGET_ENTER()
+#define ISR_BUDGET_EXIT(id)
+
+#endif
+
+#endif /* __ISR_BUDGET_H__ */
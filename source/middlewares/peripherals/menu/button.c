@@ -7,6 +7,7 @@
 #include "config.h"
 #include "drawing.h"
 #include "tim.h"
+#include "timer_wheel.h"
 
 #include <stdbool.h>
 
@@ -62,6 +63,9 @@ static bool is_level_volume_2_displayed = false;
 /// Флаг для контроля проигрывания гонга прибытия для level_volume_3
 static bool is_level_volume_3_displayed = false;
 
+/// Таймер бездействия кнопок в режиме меню (TIME_MS_FOR_SETTINGS).
+static timer_wheel_timer_t menu_timeout_timer;
+
 /**
  * @brief Сброс флагов контроля проигрывания гонга прибытия для всех уровней
  *        громкости.
@@ -73,6 +77,33 @@ static void reset_volume_flags() {
   is_level_volume_3_displayed = false;
 }
 
+/**
+ * @brief  Бездействие кнопок в течение TIME_MS_FOR_SETTINGS (колбек
+ *         menu_timeout_timer): выход из меню без сохранения настроек.
+ * @param  None
+ * @retval None
+ */
+static void menu_timeout_elapsed() {
+  /* Текущее состояние матрицы: MATRIX_STATE_START,
+   MATRIX_STATE_WORKING, MATRIX_STATE_MENU */
+  extern matrix_state_t matrix_state;
+
+  /* Текущее состояние меню: MENU_STATE_OPEN, MENU_STATE_WORKING,
+   MENU_STATE_CLOSE */
+  extern menu_state_t menu_state;
+
+  if (matrix_state != MATRIX_STATE_MENU) {
+    return;
+  }
+
+  btn_1_set_mode_counter = 0;
+  btn_2_set_value_counter = 0;
+  is_first_btn_clicked = true;
+  matrix_state = MATRIX_STATE_START;
+  menu_state = MENU_STATE_OPEN;
+  scheduler_notify(TASK_PROTOCOL);
+}
+
 /**
  * @brief  Обработка прерываний для кнопок.
  *         BUTTON_1_Pin и BUTTON_2_Pin используются для меню.
@@ -84,9 +115,6 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
    MATRIX_STATE_WORKING, MATRIX_STATE_MENU */
   extern matrix_state_t matrix_state;
 
-  /// Счетчик прошедшего в мс времени между последними нажатиями кнопок.
-  extern uint32_t time_since_last_press_ms;
-
   /* Нажатие кнопки 1 */
   if (GPIO_Pin == BUTTON_1_Pin) {
     is_button_1_pressed = true;
@@ -106,10 +134,15 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
     }
   }
 
-  /* Если нажата кнопка 1 или кнопка 2, то остаемся в режиме меню, сбрасываем
-   * счетчик времени пребывания в режиме меню */
+  /* Если нажата кнопка 1 или кнопка 2, то остаемся в режиме меню,
+   * перезапускаем таймер бездействия кнопок */
   if (GPIO_Pin == BUTTON_1_Pin || GPIO_Pin == BUTTON_2_Pin) {
-    time_since_last_press_ms = 0;
+    timer_wheel_start_once(&menu_timeout_timer, TIME_MS_FOR_SETTINGS,
+                           menu_timeout_elapsed);
+
+    // Задача протокола останавливает протокол, задача меню - обработка
+    scheduler_notify(TASK_PROTOCOL);
+    scheduler_notify(TASK_MENU);
   }
 }
 
@@ -132,13 +165,105 @@ static uint8_t selected_id;
 static drawing_data_t drawing_data = {0, 0};
 
 /**
- * @brief  Обработка нажатий BUTTON_1 и BUTTON_2.
+ * Точки ожидания меню: строка меню отображается, пока выполняется условие
+ * точки (счетчики нажатий изменяются в прерывании кнопок). press_button()
+ * возвращается в точке ожидания, следующий вызов продолжается с нее.
+ */
+typedef enum {
+  MENU_HOLD_NONE = 0,
+  MENU_HOLD_MODE_VOLUME,   // Режим VOL
+  MENU_HOLD_MODE_ID,       // Режим ID
+  MENU_HOLD_RETURN_VOLUME, // Режим VOL после выбора уровня громкости
+  MENU_HOLD_MODE_ESC,      // Режим ESC
+  MENU_HOLD_RETURN_ID,     // Режим ID после выбора адреса
+  MENU_HOLD_VALUE_VOLUME,  // Выбор уровня громкости
+  MENU_HOLD_VALUE_ID       // Выбор адреса
+} menu_hold_t;
+
+/// Текущая точка ожидания меню
+static menu_hold_t menu_hold = MENU_HOLD_NONE;
+
+/// Строка меню для задачи отображения (строка точки ожидания)
+static char *menu_string = NULL;
+
+/**
+ * @brief  Проверка условия точки ожидания меню.
+ * @param  hold:      Точка ожидания.
+ * @param  condition: Условие ожидания (по счетчикам нажатий).
+ * @param  string:    Строка для отображения во время ожидания.
+ * @retval true, если ожидание продолжается (press_button() возвращается).
+ */
+static bool menu_wait_while(menu_hold_t hold, bool condition, char *string) {
+  menu_hold = condition ? hold : MENU_HOLD_NONE;
+  menu_string = string;
+  return condition;
+}
+
+/**
+ * @brief  Строка уровня громкости для отображения в меню.
+ * @param  level: Уровень громкости 0..VOLUME_LEVEL_LIMIT.
+ * @retval Строка уровня громкости.
+ */
+static char *level_volume_string(uint8_t level) {
+  switch (level) {
+  case 0:
+    return LEVEL_VOLUME_0;
+  case 1:
+    return LEVEL_VOLUME_1;
+  case 2:
+    return LEVEL_VOLUME_2;
+  default:
+    return LEVEL_VOLUME_3;
+  }
+}
+
+/**
+ * @brief  Гонг выбранного уровня громкости (1 раз при переходе к уровню).
+ * @param  level: Уровень громкости 0..VOLUME_LEVEL_LIMIT.
+ * @retval None
+ */
+static void play_level_volume(uint8_t level) {
+  switch (level) {
+  case 0:
+    play_bip_for_menu(&is_level_volume_0_displayed, VOLUME_0);
+    is_level_volume_3_displayed = false;
+    break;
+  case 1:
+    play_bip_for_menu(&is_level_volume_1_displayed, VOLUME_1);
+    is_level_volume_0_displayed = false;
+    break;
+  case 2:
+    play_bip_for_menu(&is_level_volume_2_displayed, VOLUME_2);
+    is_level_volume_1_displayed = false;
+    break;
+  case 3:
+    play_bip_for_menu(&is_level_volume_3_displayed, VOLUME_3);
+    is_level_volume_2_displayed = false;
+    break;
+  }
+}
+
+/**
+ * @brief  Получение строки меню для задачи отображения.
+ * @param  None
+ * @retval Строка точки ожидания меню или NULL (строки нет).
+ */
+char *menu_display_string() {
+  return menu_hold != MENU_HOLD_NONE ? menu_string : NULL;
+}
+
+/**
+ * @brief  Обработка нажатий BUTTON_1 и BUTTON_2 (задача меню, не блокирует).
  * @note   Когда BUTTON_1 нажата 1 раз, то индикатор переходит в состояние меню
  *         matrix_state = MATRIX_STATE_MENU,
  *         BUTTON_1 позволяет выбирать режим меню: ID (адрес индикатора), VOLUME
  *                  (уровень громкости), ESCAPE (выход из меню С сохранением
  *                  выбранных значений).
  *         BUTTON_2 позволяет выбрать значение для ID, VOLUME.
+ *         Строка режима или значения отображается задачей отображения
+ *         (menu_display_string()), пока счетчики нажатий не изменятся: вызов
+ *         возвращается в точке ожидания menu_hold_t и следующий вызов
+ *         продолжается с нее.
  * @param  None
  * @retval None
  */
@@ -153,6 +278,7 @@ void press_button() {
     reset_volume_flags();
 
     is_first_btn_clicked = false;
+    menu_hold = MENU_HOLD_NONE;
 
     btn_2_set_value_counter = 0;
 
@@ -187,6 +313,26 @@ void press_button() {
     selected_id = id;
   }
 
+  /* Продолжение с точки ожидания */
+  switch (menu_hold) {
+  case MENU_HOLD_MODE_VOLUME:
+    goto hold_mode_volume;
+  case MENU_HOLD_MODE_ID:
+    goto hold_mode_id;
+  case MENU_HOLD_RETURN_VOLUME:
+    goto hold_return_volume;
+  case MENU_HOLD_MODE_ESC:
+    goto hold_mode_esc;
+  case MENU_HOLD_RETURN_ID:
+    goto hold_return_id;
+  case MENU_HOLD_VALUE_VOLUME:
+    goto hold_value_volume;
+  case MENU_HOLD_VALUE_ID:
+    goto hold_value_id;
+  case MENU_HOLD_NONE:
+    break;
+  }
+
   /* Нажатие кнопки 1: переключение режимов меню */
   if (is_button_1_pressed) {
     is_button_1_pressed = false;
@@ -195,25 +341,37 @@ void press_button() {
     case 1:
 
       /* Режим VOL (уровень громкости) */
-      while (btn_1_set_mode_counter == 1 && btn_2_set_value_counter == 0) {
-        draw_string_on_matrix(SETTINGS_MODE_VOLUME);
+    hold_mode_volume:
+      if (menu_wait_while(MENU_HOLD_MODE_VOLUME,
+                          btn_1_set_mode_counter == 1 &&
+                              btn_2_set_value_counter == 0,
+                          SETTINGS_MODE_VOLUME)) {
         btn_1_settings_mode = LEVEL_VOLUME;
+        return;
       }
 
       break;
     case 2:
 
       /* Режим ID (адрес индмкатора) */
-      while (btn_1_set_mode_counter == 2 && btn_2_set_value_counter == 0) {
-        draw_string_on_matrix(SETTINGS_MODE_ID);
+    hold_mode_id:
+      if (menu_wait_while(MENU_HOLD_MODE_ID,
+                          btn_1_set_mode_counter == 2 &&
+                              btn_2_set_value_counter == 0,
+                          SETTINGS_MODE_ID)) {
         btn_1_settings_mode = ID;
+        return;
       }
 
       /* Для режима LEVEL_VOLUME: возврат к режиму LEVEL_VOLUME
        * ПОСЛЕ выбора значения уровня громкости */
-      while (btn_1_settings_mode == LEVEL_VOLUME &&
-             btn_1_set_mode_counter == 2 && btn_2_set_value_counter == 1) {
-        draw_string_on_matrix(SETTINGS_MODE_VOLUME);
+    hold_return_volume:
+      if (menu_wait_while(MENU_HOLD_RETURN_VOLUME,
+                          btn_1_settings_mode == LEVEL_VOLUME &&
+                              btn_1_set_mode_counter == 2 &&
+                              btn_2_set_value_counter == 1,
+                          SETTINGS_MODE_VOLUME)) {
+        return;
       }
 
       /* Возврат к выбору значения уровня громкости в режиме LEVEL_VOLUME */
@@ -237,9 +395,13 @@ void press_button() {
         reset_volume_flags();
       }
 
-      while (btn_1_set_mode_counter == 3 && btn_2_set_value_counter == 0) {
-        draw_string_on_matrix(SETTINGS_MODE_ESC);
+    hold_mode_esc:
+      if (menu_wait_while(MENU_HOLD_MODE_ESC,
+                          btn_1_set_mode_counter == 3 &&
+                              btn_2_set_value_counter == 0,
+                          SETTINGS_MODE_ESC)) {
         btn_1_settings_mode = ESC;
+        return;
       }
 
       if (btn_2_set_value_counter == 0) {
@@ -247,9 +409,13 @@ void press_button() {
       } else {
         /* Для режима ID: возврат к режиму ID
          * ПОСЛЕ выбора значения адреса */
-        while (btn_1_settings_mode == ID && btn_1_set_mode_counter == 3 &&
-               btn_2_set_value_counter == 1) {
-          draw_string_on_matrix(SETTINGS_MODE_ID);
+      hold_return_id:
+        if (menu_wait_while(MENU_HOLD_RETURN_ID,
+                            btn_1_settings_mode == ID &&
+                                btn_1_set_mode_counter == 3 &&
+                                btn_2_set_value_counter == 1,
+                            SETTINGS_MODE_ID)) {
+          return;
         }
 
         /* Возврат к режиму ID */
@@ -284,33 +450,15 @@ void press_button() {
         switch (btn_1_settings_mode) {
         case LEVEL_VOLUME: /* Выбор значения для уровня громкости */
           selected_level_volume = level_volume;
-          while (btn_1_settings_mode == LEVEL_VOLUME &&
-                 btn_2_set_value_counter == 1 && btn_1_set_mode_counter == 1) {
-            if (level_volume == 0) {
-              draw_string_on_matrix(LEVEL_VOLUME_0);
-              play_bip_for_menu(&is_level_volume_0_displayed, VOLUME_0);
-
-              is_level_volume_3_displayed = false;
-            }
-
-            if (level_volume == 1) {
-              draw_string_on_matrix(LEVEL_VOLUME_1);
-              play_bip_for_menu(&is_level_volume_1_displayed, VOLUME_1);
-
-              is_level_volume_0_displayed = false;
-            }
-            if (level_volume == 2) {
-              draw_string_on_matrix(LEVEL_VOLUME_2);
-              play_bip_for_menu(&is_level_volume_2_displayed, VOLUME_2);
-
-              is_level_volume_1_displayed = false;
-            }
-            if (level_volume == 3) {
-              draw_string_on_matrix(LEVEL_VOLUME_3);
-              play_bip_for_menu(&is_level_volume_3_displayed, VOLUME_3);
-
-              is_level_volume_2_displayed = false;
-            }
+
+        hold_value_volume:
+          if (menu_wait_while(MENU_HOLD_VALUE_VOLUME,
+                              btn_1_settings_mode == LEVEL_VOLUME &&
+                                  btn_2_set_value_counter == 1 &&
+                                  btn_1_set_mode_counter == 1,
+                              level_volume_string(level_volume))) {
+            play_level_volume(level_volume);
+            return;
           }
 
           level_volume++;
@@ -327,14 +475,18 @@ void press_button() {
             matrix_string[LSB] = 'c';
           } else {
             drawing_data.floor = id;
-            setting_symbols(matrix_string, &drawing_data, ADDR_ID_LIMIT, NULL,
-                            0);
+            setting_symbols(matrix_string, &drawing_data, ADDR_ID_LIMIT);
           }
 
           selected_id = id;
-          while (btn_1_settings_mode == ID && btn_2_set_value_counter == 1 &&
-                 btn_1_set_mode_counter == 2) {
-            draw_string_on_matrix(matrix_string);
+
+        hold_value_id:
+          if (menu_wait_while(MENU_HOLD_VALUE_ID,
+                              btn_1_settings_mode == ID &&
+                                  btn_2_set_value_counter == 1 &&
+                                  btn_1_set_mode_counter == 2,
+                              matrix_string)) {
+            return;
           }
 
           /* Установка следующего за отображенным id */
@@ -8,7 +8,7 @@
 #include <stdint.h>
 
 /**
- * @brief  Обработка нажатий BUTTON_1 и BUTTON_2.
+ * @brief  Обработка нажатий BUTTON_1 и BUTTON_2 (задача меню, не блокирует).
  * @note   Когда BUTTON_1 нажата 1 раз, то индикатор переходит в состояние меню
  *         matrix_state = MATRIX_STATE_MENU,
  *         BUTTON_1 позволяет выбирать режим меню: ID (адрес индикатора), VOLUME
@@ -20,4 +20,11 @@
  */
 void press_button();
 
+/**
+ * @brief  Получение строки меню для задачи отображения.
+ * @param  None
+ * @retval Строка режима или значения меню или NULL (строки нет).
+ */
+char *menu_display_string();
+
 #endif /*__ BUTTON_H__ */
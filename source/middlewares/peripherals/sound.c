@@ -0,0 +1,123 @@
+/**
+ * @file sound.c
+ */
+#include "sound.h"
+
+#include "buzzer.h"
+#include "tim.h"
+
+#define SOUND_GONG_FREQ 1000 ///< Частота первого тона гонга
+#define SOUND_ALARM_FREQ                                                       \
+  3000 ///< Частота тона бузера при перегрузе кабины и пожарной опасности
+
+/// Кол-во тонов однократного звука (индекс - sound_id_t), 0 - непрерывный
+static const uint8_t sound_bip_count[SOUND_COUNT] = {
+    [SOUND_CALL_BUTTON] = 1, [SOUND_DOOR_OPEN] = 1,    [SOUND_DOOR_CLOSE] = 2,
+    [SOUND_GONG_UP] = 1,     [SOUND_GONG_DOWN] = 2,    [SOUND_GONG_NO_MOVE] = 3,
+};
+
+extern uint8_t _bip_counter;
+
+/// Состояние арбитра звуков
+static sound_arbiter_t arbiter;
+
+/// Уровень громкости однократных звуков
+static uint8_t sound_volume = VOLUME_0;
+
+/**
+ * @brief  Воспроизведение звука, выбранного арбитром.
+ * @param  sound: Звук, SOUND_NONE - выключение бузера.
+ * @retval None
+ */
+static void sound_output(sound_id_t sound) {
+  stop_buzzer_sound();
+
+  switch (sound) {
+  case SOUND_NONE:
+    break;
+
+  case SOUND_CABIN_OVERLOAD:
+  case SOUND_FIRE_DANGER:
+    TIM2_Start_bip(SOUND_ALARM_FREQ, VOLUME_3);
+    break;
+
+  case SOUND_CALL_BUTTON:
+    play_gong(sound_bip_count[sound], SOUND_GONG_FREQ, sound_volume,
+              BIP_DURATION_CALL_BTN);
+    break;
+
+  case SOUND_DOOR_OPEN:
+  case SOUND_DOOR_CLOSE:
+    play_gong(sound_bip_count[sound], SOUND_GONG_FREQ, sound_volume,
+              BIP_DURATION_DOORS);
+    break;
+
+  default:
+    play_gong(sound_bip_count[sound], SOUND_GONG_FREQ, sound_volume,
+              BIP_DURATION_GONG);
+    break;
+  }
+}
+
+/**
+ * @brief  Передача события арбитру и переключение бузера по его решению.
+ * @param  input: Входное событие.
+ * @param  sound: Звук события.
+ * @retval None
+ */
+static void sound_dispatch(sound_input_t input, sound_id_t sound) {
+  if (sound_arbiter_decide(&arbiter, input, sound, HAL_GetTick())) {
+    sound_output(arbiter.playing);
+  }
+}
+
+/**
+ * @brief  Сброс звуков: бузер выключен, очередь пуста.
+ * @param  volume: Уровень громкости однократных звуков (volume_t), VOLUME_0 -
+ *                 звуки не воспроизводятся.
+ * @retval None
+ */
+void sound_reset(uint8_t volume) {
+  sound_volume = volume;
+  sound_arbiter_reset(&arbiter);
+  stop_buzzer_sound();
+}
+
+/**
+ * @brief  Запрос звука (для непрерывного звука - включение).
+ * @param  sound: Звук.
+ * @retval None
+ */
+void sound_request(sound_id_t sound) {
+  if (sound_volume != VOLUME_0) {
+    sound_dispatch(SOUND_INPUT_REQUEST, sound);
+  }
+}
+
+/**
+ * @brief  Выключение непрерывного звука.
+ * @param  sound: Звук.
+ * @retval None
+ */
+void sound_release(sound_id_t sound) {
+  sound_dispatch(SOUND_INPUT_RELEASE, sound);
+}
+
+/**
+ * @brief  Обработка звуков (вызывается в главном цикле): завершение
+ *         однократного звука и время ожидания звуков в очереди.
+ * @note   Однократный звук завершен, когда TIM1 отработал все тоны
+ *         (_bip_counter сброшен в stop_buzzer_sound()).
+ * @param  None
+ * @retval None
+ */
+void sound_process(void) {
+  bool is_one_shot = arbiter.playing != SOUND_NONE &&
+                     !sound_is_continuous(arbiter.playing);
+
+  if (is_one_shot && _bip_counter == 0) {
+    sound_dispatch(SOUND_INPUT_FINISHED, SOUND_NONE);
+  } else if (arbiter.queue_count != 0) {
+    sound_dispatch(SOUND_INPUT_TICK, SOUND_NONE);
+  }
+}
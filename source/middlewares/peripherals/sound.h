@@ -0,0 +1,42 @@
+/**
+ * @file    sound.h
+ * @brief   Этот файл содержит прототипы функций для файла sound.c
+ */
+#ifndef __SOUND_H__
+#define __SOUND_H__
+
+#include "sound_arbiter.h"
+
+#include <stdint.h>
+
+/**
+ * @brief  Сброс звуков: бузер выключен, очередь пуста.
+ * @param  volume: Уровень громкости однократных звуков (volume_t), VOLUME_0 -
+ *                 звуки не воспроизводятся.
+ * @retval None
+ */
+void sound_reset(uint8_t volume);
+
+/**
+ * @brief  Запрос звука (для непрерывного звука - включение).
+ * @param  sound: Звук.
+ * @retval None
+ */
+void sound_request(sound_id_t sound);
+
+/**
+ * @brief  Выключение непрерывного звука.
+ * @param  sound: Звук.
+ * @retval None
+ */
+void sound_release(sound_id_t sound);
+
+/**
+ * @brief  Обработка звуков (вызывается в главном цикле): завершение
+ *         однократного звука и время ожидания звуков в очереди.
+ * @param  None
+ * @retval None
+ */
+void sound_process(void);
+
+#endif /* __SOUND_H__ */
@@ -0,0 +1,260 @@
+/**
+ * @file sound_arbiter.c
+ */
+#include "sound_arbiter.h"
+
+/**
+ * Описание звука для арбитра.
+ */
+typedef struct {
+  uint8_t priority;   // Приоритет (больше - важнее)
+  bool is_continuous; // Непрерывный звук (уровень сигнала)
+  bool is_resumable;  // Прерванный звук воспроизводится заново
+} sound_descriptor_t;
+
+/// Описания звуков (индекс - sound_id_t)
+static const sound_descriptor_t sound_descriptors[SOUND_COUNT] = {
+    [SOUND_NONE] = {0, false, false},
+    [SOUND_CALL_BUTTON] = {1, false, false},
+    [SOUND_DOOR_OPEN] = {2, false, false},
+    [SOUND_DOOR_CLOSE] = {2, false, false},
+    [SOUND_GONG_UP] = {3, false, true},
+    [SOUND_GONG_DOWN] = {3, false, true},
+    [SOUND_GONG_NO_MOVE] = {3, false, true},
+    [SOUND_CABIN_OVERLOAD] = {4, true, false},
+    [SOUND_FIRE_DANGER] = {5, true, false},
+};
+
+_Static_assert(SOUND_COUNT <= 16,
+               "sound_arbiter_t.active_alarms holds up to 16 sounds");
+
+/**
+ * @brief  Приоритет звука.
+ * @param  sound: Звук.
+ * @retval Приоритет, 0 - нет звука.
+ */
+static uint8_t sound_priority(uint8_t sound) {
+  return sound_descriptors[sound].priority;
+}
+
+/**
+ * @brief  Удаление звука из очереди по индексу.
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @param  index:   Индекс звука в очереди.
+ * @retval None
+ */
+static void queue_remove(sound_arbiter_t *arbiter, uint8_t index) {
+  for (uint8_t i = index; i + 1 < arbiter->queue_count; i++) {
+    arbiter->queue[i] = arbiter->queue[i + 1];
+  }
+  arbiter->queue_count--;
+}
+
+/**
+ * @brief  Постановка звука в очередь.
+ * @note   Звук с тем же приоритетом в очереди заменяется (актуален последний
+ *         запрос). При заполненной очереди отбрасывается самый старый звук с
+ *         наименьшим приоритетом, если он не важнее нового.
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @param  sound:   Звук.
+ * @param  now_ms:  Время запроса в мс.
+ * @retval None
+ */
+static void queue_push(sound_arbiter_t *arbiter, uint8_t sound,
+                       uint32_t now_ms) {
+  uint8_t priority = sound_priority(sound);
+
+  for (uint8_t i = 0; i < arbiter->queue_count; i++) {
+    if (sound_priority(arbiter->queue[i].sound) == priority) {
+      queue_remove(arbiter, i);
+      break;
+    }
+  }
+
+  if (arbiter->queue_count == SOUND_QUEUE_SIZE) {
+    uint8_t lowest = 0;
+    for (uint8_t i = 1; i < arbiter->queue_count; i++) {
+      if (sound_priority(arbiter->queue[i].sound) <
+          sound_priority(arbiter->queue[lowest].sound)) {
+        lowest = i;
+      }
+    }
+
+    if (sound_priority(arbiter->queue[lowest].sound) > priority) {
+      return;
+    }
+    queue_remove(arbiter, lowest);
+  }
+
+  arbiter->queue[arbiter->queue_count].sound = sound;
+  arbiter->queue[arbiter->queue_count].request_ms = now_ms;
+  arbiter->queue_count++;
+}
+
+/**
+ * @brief  Удаление звуков, ожидающих дольше SOUND_QUEUE_MAX_AGE_MS.
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @param  now_ms:  Текущее время в мс.
+ * @retval None
+ */
+static void queue_drop_expired(sound_arbiter_t *arbiter, uint32_t now_ms) {
+  uint8_t i = 0;
+
+  while (i < arbiter->queue_count) {
+    if (now_ms - arbiter->queue[i].request_ms > SOUND_QUEUE_MAX_AGE_MS) {
+      queue_remove(arbiter, i);
+    } else {
+      i++;
+    }
+  }
+}
+
+/**
+ * @brief  Непрерывный звук с наибольшим приоритетом.
+ * @param  active_alarms: Включенные непрерывные звуки (бит на sound_id_t).
+ * @retval Звук или SOUND_NONE.
+ */
+static uint8_t top_alarm(uint16_t active_alarms) {
+  uint8_t top = SOUND_NONE;
+
+  for (uint8_t sound = SOUND_NONE + 1; sound < SOUND_COUNT; sound++) {
+    if ((active_alarms & (1U << sound)) &&
+        sound_priority(sound) > sound_priority(top)) {
+      top = sound;
+    }
+  }
+
+  return top;
+}
+
+/**
+ * @brief  Индекс звука с наибольшим приоритетом в очереди (из равных - более
+ *         ранний запрос).
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @retval Индекс или SOUND_QUEUE_SIZE, если очередь пуста.
+ */
+static uint8_t queue_top(const sound_arbiter_t *arbiter) {
+  uint8_t top = SOUND_QUEUE_SIZE;
+
+  for (uint8_t i = 0; i < arbiter->queue_count; i++) {
+    if (top == SOUND_QUEUE_SIZE ||
+        sound_priority(arbiter->queue[i].sound) >
+            sound_priority(arbiter->queue[top].sound)) {
+      top = i;
+    }
+  }
+
+  return top;
+}
+
+/**
+ * @brief  Сброс состояния арбитра (звук выключен, очередь пуста).
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @retval None
+ */
+void sound_arbiter_reset(sound_arbiter_t *arbiter) {
+  arbiter->playing = SOUND_NONE;
+  arbiter->active_alarms = 0;
+  arbiter->queue_count = 0;
+}
+
+/**
+ * @brief  Проверка типа звука.
+ * @param  sound: Звук.
+ * @retval true для непрерывного звука (пожар, перегруз).
+ */
+bool sound_is_continuous(sound_id_t sound) {
+  return sound < SOUND_COUNT && sound_descriptors[sound].is_continuous;
+}
+
+/**
+ * @brief  Решение об источнике звука по входному событию.
+ * @note   1. Звук с большим приоритетом прерывает текущий. Прерванный гонг
+ *            ставится в очередь и воспроизводится заново, прерванные звуки
+ *            дверей и кнопки отбрасываются, непрерывный звук продолжается
+ *            после завершения более важного;
+ *         2. Звук с меньшим приоритетом ждет в очереди не дольше
+ *            SOUND_QUEUE_MAX_AGE_MS, звук с равным приоритетом заменяет
+ *            текущий.
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @param  input:   Входное событие.
+ * @param  sound:   Звук для SOUND_INPUT_REQUEST/SOUND_INPUT_RELEASE.
+ * @param  now_ms:  Текущее время в мс.
+ * @retval true, если arbiter->playing нужно (пере)запустить или выключить
+ *         (SOUND_NONE).
+ */
+bool sound_arbiter_decide(sound_arbiter_t *arbiter, sound_input_t input,
+                          sound_id_t sound, uint32_t now_ms) {
+  uint8_t current = arbiter->playing;
+
+  if (sound >= SOUND_COUNT) {
+    sound = SOUND_NONE;
+  }
+
+  switch (input) {
+  case SOUND_INPUT_REQUEST:
+    if (sound_is_continuous(sound)) {
+      arbiter->active_alarms |= 1U << sound;
+    } else if (sound != SOUND_NONE) {
+      queue_push(arbiter, sound, now_ms);
+    }
+    break;
+
+  case SOUND_INPUT_RELEASE:
+    arbiter->active_alarms &= ~(1U << sound);
+    break;
+
+  case SOUND_INPUT_FINISHED:
+    if (!sound_is_continuous(current)) {
+      current = SOUND_NONE;
+    }
+    break;
+
+  case SOUND_INPUT_TICK:
+  default:
+    break;
+  }
+
+  // Выключенный непрерывный звук больше не воспроизводится
+  if (sound_is_continuous(current) &&
+      (arbiter->active_alarms & (1U << current)) == 0) {
+    current = SOUND_NONE;
+  }
+
+  queue_drop_expired(arbiter, now_ms);
+
+  uint8_t alarm = top_alarm(arbiter->active_alarms);
+  uint8_t queued = queue_top(arbiter);
+  uint8_t candidate = current;
+  bool is_from_queue = false;
+
+  if (sound_priority(alarm) > sound_priority(candidate)) {
+    candidate = alarm;
+  }
+
+  // Запрос с равным приоритетом заменяет текущий звук
+  if (queued != SOUND_QUEUE_SIZE &&
+      sound_priority(arbiter->queue[queued].sound) >=
+          sound_priority(candidate)) {
+    candidate = arbiter->queue[queued].sound;
+    is_from_queue = true;
+  }
+
+  if (is_from_queue) {
+    queue_remove(arbiter, queued);
+  }
+
+  if (candidate == arbiter->playing && !is_from_queue) {
+    return false;
+  }
+
+  // Прерванный однократный звук: заново из очереди или отбрасывается
+  if (current != SOUND_NONE && candidate != current &&
+      sound_priority(candidate) > sound_priority(current) &&
+      sound_descriptors[current].is_resumable) {
+    queue_push(arbiter, current, now_ms);
+  }
+
+  arbiter->playing = candidate;
+  return true;
+}
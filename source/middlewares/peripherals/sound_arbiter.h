@@ -0,0 +1,95 @@
+/**
+ * @file    sound_arbiter.h
+ * @brief   Этот файл содержит прототипы функций для файла sound_arbiter.c
+ * @note    Модуль не зависит от HAL (решение об источнике звука проверяется
+ *          на ПК).
+ */
+#ifndef __SOUND_ARBITER_H__
+#define __SOUND_ARBITER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SOUND_QUEUE_SIZE 4 ///< Кол-во звуков в очереди ожидания
+#define SOUND_QUEUE_MAX_AGE_MS                                                 \
+  3000 ///< Время ожидания звука в очереди, после - звук отбрасывается
+
+/**
+ * Звуки индикатора. Приоритет (по убыванию): пожарная опасность, перегруз
+ * кабины, гонг, двери, кнопка вызова.
+ */
+typedef enum {
+  SOUND_NONE = 0,
+  SOUND_CALL_BUTTON,    // Кнопка вызова (1 тон)
+  SOUND_DOOR_OPEN,      // Открытие дверей (1 тон)
+  SOUND_DOOR_CLOSE,     // Закрытие дверей (2 тона)
+  SOUND_GONG_UP,        // Гонг, направление вверх (1 тон)
+  SOUND_GONG_DOWN,      // Гонг, направление вниз (2 тона)
+  SOUND_GONG_NO_MOVE,   // Гонг без направления (3 тона)
+  SOUND_CABIN_OVERLOAD, // Перегруз кабины (непрерывный)
+  SOUND_FIRE_DANGER,    // Пожарная опасность (непрерывный)
+  SOUND_COUNT
+} sound_id_t;
+
+/**
+ * Входные события арбитра.
+ */
+typedef enum {
+  SOUND_INPUT_REQUEST,  // Запрос звука (для непрерывного - включение)
+  SOUND_INPUT_RELEASE,  // Выключение непрерывного звука
+  SOUND_INPUT_FINISHED, // Текущий однократный звук завершен
+  SOUND_INPUT_TICK      // Проверка времени ожидания звуков в очереди
+} sound_input_t;
+
+/**
+ * Звук в очереди ожидания.
+ */
+typedef struct {
+  uint8_t sound;       // sound_id_t
+  uint32_t request_ms; // Время запроса
+} sound_queue_entry_t;
+
+/**
+ * Состояние арбитра.
+ */
+typedef struct {
+  uint8_t playing;        // Текущий звук (sound_id_t)
+  uint16_t active_alarms; // Включенные непрерывные звуки (бит на sound_id_t)
+  sound_queue_entry_t queue[SOUND_QUEUE_SIZE]; // Очередь (в порядке запроса)
+  uint8_t queue_count;                         // Кол-во звуков в очереди
+} sound_arbiter_t;
+
+/**
+ * @brief  Сброс состояния арбитра (звук выключен, очередь пуста).
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @retval None
+ */
+void sound_arbiter_reset(sound_arbiter_t *arbiter);
+
+/**
+ * @brief  Решение об источнике звука по входному событию.
+ * @note   1. Звук с большим приоритетом прерывает текущий. Прерванный гонг
+ *            ставится в очередь и воспроизводится заново, прерванные звуки
+ *            дверей и кнопки отбрасываются, непрерывный звук продолжается
+ *            после завершения более важного;
+ *         2. Звук с меньшим приоритетом ждет в очереди не дольше
+ *            SOUND_QUEUE_MAX_AGE_MS, звук с равным приоритетом заменяет
+ *            текущий.
+ * @param  arbiter: Указатель на состояние арбитра.
+ * @param  input:   Входное событие.
+ * @param  sound:   Звук для SOUND_INPUT_REQUEST/SOUND_INPUT_RELEASE.
+ * @param  now_ms:  Текущее время в мс.
+ * @retval true, если arbiter->playing нужно (пере)запустить или выключить
+ *         (SOUND_NONE).
+ */
+bool sound_arbiter_decide(sound_arbiter_t *arbiter, sound_input_t input,
+                          sound_id_t sound, uint32_t now_ms);
+
+/**
+ * @brief  Проверка типа звука.
+ * @param  sound: Звук.
+ * @retval true для непрерывного звука (пожар, перегруз).
+ */
+bool sound_is_continuous(sound_id_t sound);
+
+#endif /* __SOUND_ARBITER_H__ */
@@ -7,19 +7,18 @@
 
 /* USER CODE BEGIN 0 */
 #include "config.h"
+#include "irq_priority.h"
+#include "timer_wheel.h"
 
-#define TIM4_FREQ TIM2_FREQ ///< Частота линии APB1 для TIM4
+#define TIM4_FREQ TIM2_FREQ ///< Частота таймеров APB1 для TIM4
 
-#if PROTOCOL_UIM_6100 || PROTOCOL_UEL || PROTOCOL_UKL || PROTOCOL_ALPACA
-#define TIME_DISPLAY_STRING_DURING_MS                                          \
-  3000 ///< Время в мс, в течение которого отображается строка при подаче
-       ///< питания
+_Static_assert(TIM1_FREQ % FREQ_FOR_US == 0 && TIM2_FREQ % FREQ_FOR_US == 0,
+               "Timer clocks: whole MHz required for 1 us ticks");
+_Static_assert(TIM1_PRESCALER_FOR_US <= 0xFFFF && PRESCALER_FOR_US <= 0xFFFF,
+               "Timer prescaler for 1 us exceeds 16 bits");
 
-#elif DEMO_MODE
-#define TIME_DISPLAY_STRING_DURING_MS                                          \
-  2000 ///< Время в мс, в течение которого отображается строка
-
-#endif
+/// Кол-во мс в единице bip_duration_ms (тон гонга вдвое длиннее значения)
+#define BIP_DURATION_SCALE 2
 
 /**
  * @brief  Запуск таймера 2 на 2-ом канале в режиме ШИМ (для пассивного бузера).
@@ -137,189 +136,84 @@ void TIM2_Stop_bip() {
   TIM2_Stop_PWM();
 }
 
-/// Счетчик для подсчета продолжительности тонов гонга.
-volatile uint32_t tim1_elapsed_ms = 0;
-
-/**
- * @brief  Остановка TIM1.
- * @note   Сброс счетчика для подсчета продолжительности тонов гонга.
- * @param  None
- * @retval None
- */
-static void TIM1_Stop() {
-  tim1_elapsed_ms = 0;
-  HAL_TIM_Base_Stop_IT(&htim1);
-  HAL_TIM_OC_Stop_IT(&htim1, TIM_CHANNEL_1);
-}
-
-/// Флаг для контроля завершения периода TIM3
-volatile bool is_tim3_period_elapsed = false;
-
 /// Флаг для удержания состояния строки в темение 1 мс (максимвльная яркость,
 /// частота обновления матрицы 125 Гц).
 volatile bool is_tim4_period_elapsed = false;
 
-/// Счетчик прошедшего в мс времени между последними нажатиями кнопок.
-volatile uint32_t time_since_last_press_ms = 0;
-
-/// Счетчик прошедшего в мс времени для проверки подключения интерфейса (CAN,
-/// USART)
-volatile uint32_t connection_ms_is_elapsed = 0;
-
-/// Флаг для отображения строки в течение TIME_DISPLAY_STRING_DURING_MS
-volatile bool is_time_ms_for_display_str_elapsed = false;
-
-/// Счетчик времени отображения строки при запуске индикатора в мс
-static uint16_t tim4_ms_counter = 0;
-
 /**
  * @brief  Обработка прерываний по завершении периода таймеров.
  * @param  htim: Указатель на структуру таймера.
  * @retval None
  */
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
-  /// Флаг для детектирования первого нажатия кнопки 1 (вход в меню - считывание
-  /// настроек из flash-памяти).
-  extern bool is_first_btn_clicked;
-
-  /// Счетчик кол-ва нажатий BUTTON_1
-  extern uint8_t btn_1_set_mode_counter;
-
-  /// Счетчик кол-ва нажатий BUTTON_2
-  extern uint8_t btn_2_set_value_counter;
-
-  /// Текущее состояние индикатора: MATRIX_STATE_START, MATRIX_STATE_WORKING,
-  /// MATRIX_STATE_MENU
-  extern matrix_state_t matrix_state;
-
-  /// Текущее состояние меню: MENU_STATE_OPEN, MENU_STATE_WORKING,
-  /// MENU_STATE_CLOSE
-  extern menu_state_t menu_state;
-
-  if (htim->Instance == TIM3) {
-    is_tim3_period_elapsed = true; // для TEST_MODE
-
-#if PROTOCOL_UKL
-
-    read_data_bit();
-
-#endif
-  }
-
   if (htim->Instance == TIM4) {
     /* Флаг для отсчета 1 мс (время удержания состояния одной строки с
      * колонками) для отображения символов */
     is_tim4_period_elapsed = true;
 
-/* Счетчик для отображения строки в течение TIME_DISPLAY_STRING_DURING_MS
- * для протоколов: название протокола и номер версии ПО при запуске
- * индикатора; для DEMO_MODE: отображение строки */
-#if !TEST_MODE
-    if (!is_time_ms_for_display_str_elapsed) {
-      tim4_ms_counter += 1;
-      if (tim4_ms_counter >= TIME_DISPLAY_STRING_DURING_MS) {
-        tim4_ms_counter = 0;
-        is_time_ms_for_display_str_elapsed = true;
-      }
-    }
-#endif
-
-#if PROTOCOL_UIM_6100 || PROTOCOL_UEL || PROTOCOL_UKL
-
-    /* Счетчик для проверки подключения интерфейса */
-    if (matrix_state == MATRIX_STATE_WORKING) {
-      connection_ms_is_elapsed += 1;
-      if (connection_ms_is_elapsed >= TIME_MS_FOR_INTERFACE_CONNECTION) {
-        connection_ms_is_elapsed = 0;
-
-        is_interface_connected = (alive_cnt[0] == alive_cnt[1]) ? false : true;
-        alive_cnt[1] = alive_cnt[0];
-      }
-    }
-
-    /* Счетчик для проверки бездействия кнопок в течение TIME_MS_FOR_SETTINGS
-     * мс */
-    if (matrix_state == MATRIX_STATE_MENU) {
-      time_since_last_press_ms += 1;
-
-      if (time_since_last_press_ms >= TIME_MS_FOR_SETTINGS) {
-        time_since_last_press_ms = 0;
-
-        btn_1_set_mode_counter = 0;
-        btn_2_set_value_counter = 0;
-        is_first_btn_clicked = true;
-        matrix_state = MATRIX_STATE_START;
-        menu_state = MENU_STATE_OPEN;
-      }
-    }
-
+#if IS_PROTOCOL_BUILD && !DEMO_MODE && !TEST_MODE
+    /* Применение строки принятого кадра на границе строки развертки */
+    display_sync_row_elapsed();
+    scheduler_notify(TASK_DISPLAY);
 #endif
   }
 }
 
-/// Знвчение частоты тона гонга для HAL_TIM_OC_DelayElapsedCallback
+/// Знвчение частоты тона гонга для gong_tone_elapsed()
 static uint16_t _bip_freq = 0;
 
-/// Кол-во тонов гонга для HAL_TIM_OC_DelayElapsedCallback
+/// Кол-во тонов гонга для gong_tone_elapsed()
 uint8_t _bip_counter = 0;
 
-/// Продолжительность тона гонга для HAL_TIM_OC_DelayElapsedCallback
+/// Продолжительность тона гонга для gong_tone_elapsed()
 static uint32_t _bip_duration_ms = 0;
 
-/// Уровень громкости тона гонга для HAL_TIM_OC_DelayElapsedCallback
+/// Уровень громкости тона гонга для gong_tone_elapsed()
 static uint16_t _bip_volume = 0;
 
-#if PROTOCOL_UIM_6100
-extern bool is_door_sound;
-#endif
+/// Таймер смены тонов гонга (период - продолжительность тона).
+static timer_wheel_timer_t gong_timer;
+
+/// Кол-во завершенных тонов гонга.
+static uint8_t gong_tones_elapsed = 0;
+
 /**
- * @brief  Выключение бузера (ШИМ TIM2 и TIM1 для подсчета продолжительности
- *         тона бузера).
+ * @brief  Выключение бузера (ШИМ TIM2 и таймер смены тонов гонга).
  * @param  None
  * @retval None
  */
 void stop_buzzer_sound() {
-  TIM1_Stop();
+  timer_wheel_stop(&gong_timer);
   TIM2_Stop_bip();
   _bip_counter = 0;
-#if PROTOCOL_UIM_6100
-  is_door_sound = false;
-#endif
 }
 
 /**
- * @brief  Output Compare колбек, подсчет продолжительности тона гонга.
+ * @brief  Завершение тона гонга (колбек gong_timer): следующий тон или
+ *         остановка после _bip_counter тонов.
+ * @param  None
+ * @retval None
+ */
+static void gong_tone_elapsed() {
+  gong_tones_elapsed++;
+
+  if (gong_tones_elapsed >= _bip_counter || gong_tones_elapsed >= 3) {
+    stop_buzzer_sound();
+  } else if (gong_tones_elapsed == 1) {
+    TIM2_Start_bip(900, _bip_volume); // Запускаем 2-ой тон
+  } else {
+    TIM2_Start_bip(800, _bip_volume); // Запускаем 3-ий тон
+  }
+}
+
+/**
+ * @brief  Output Compare колбек, короткий таймер колеса таймеров (TIM1 CH1).
  * @param  htim: Указатель на структуру таймера.
  * @retval None
  */
 void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim) {
-  if (htim->Instance == TIM1) {
-    tim1_elapsed_ms++;
-
-    if (tim1_elapsed_ms == _bip_duration_ms) {
-
-      TIM2_Start_bip(900, _bip_volume); // Запускаем 2-ой тон
-
-      if (_bip_counter == 1) {
-        stop_buzzer_sound();
-      }
-    }
-
-    if (tim1_elapsed_ms == 2 * _bip_duration_ms) {
-
-      TIM2_Start_bip(800, _bip_volume); // Запускаем 3-ий тон
-
-      if (_bip_counter == 2) {
-        stop_buzzer_sound();
-      }
-    }
-
-    if (tim1_elapsed_ms == 3 * _bip_duration_ms) { // stop bip 3
-
-      if (_bip_counter == 3) {
-        stop_buzzer_sound();
-      }
-    }
+  if (htim->Instance == TIM1 && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1) {
+    timer_wheel_us_elapsed();
   }
 }
 /* USER CODE END 0 */
@@ -344,7 +238,7 @@ void MX_TIM1_Init(void) {
 
   /* USER CODE END TIM1_Init 1 */
   htim1.Instance = TIM1;
-  htim1.Init.Prescaler = 0;
+  htim1.Init.Prescaler = TIM1_PRESCALER_FOR_US;
   htim1.Init.CounterMode = TIM_COUNTERMODE_UP;
   htim1.Init.Period = 65535;
   htim1.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
@@ -360,7 +254,7 @@ void MX_TIM1_Init(void) {
   if (HAL_TIM_OC_Init(&htim1) != HAL_OK) {
     Error_Handler();
   }
-  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
   sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
   if (HAL_TIMEx_MasterConfigSynchronization(&htim1, &sMasterConfig) != HAL_OK) {
     Error_Handler();
@@ -450,7 +344,7 @@ void Timer_Buzzer_Init_1uS(void) {
 
   /* USER CODE END TIM2_Init 1 */
   htim2.Instance = TIM2;
-  htim2.Init.Prescaler = 64 - 1; // freq tim = 1 000 000
+  htim2.Init.Prescaler = PRESCALER_FOR_US; // freq tim = 1 000 000
   htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
   htim2.Init.Period = 65535;
   htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
@@ -496,15 +390,15 @@ void MX_TIM3_Init(void) {
 
   /* USER CODE END TIM3_Init 1 */
   htim3.Instance = TIM3;
-  htim3.Init.Prescaler = 64000 - 1;
+  htim3.Init.Prescaler = 0;
   htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim3.Init.Period = 100 - 1;
+  htim3.Init.Period = 65535;
   htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
   htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_Base_Init(&htim3) != HAL_OK) {
     Error_Handler();
   }
-  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
+  sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_ITR0;
   if (HAL_TIM_ConfigClockSource(&htim3, &sClockSourceConfig) != HAL_OK) {
     Error_Handler();
   }
@@ -530,9 +424,9 @@ void MX_TIM4_Init(void) {
 
   /* USER CODE END TIM4_Init 1 */
   htim4.Instance = TIM4;
-  htim4.Init.Prescaler = 64000 - 1;
+  htim4.Init.Prescaler = TIM4_FREQ / FREQ_FOR_US - 1;
   htim4.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim4.Init.Period = 100 - 1;
+  htim4.Init.Period = 1000; // 1 мс (TIM4_Start)
   htim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
   htim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_Base_Init(&htim4) != HAL_OK) {
@@ -548,8 +442,7 @@ void MX_TIM4_Init(void) {
     Error_Handler();
   }
   /* USER CODE BEGIN TIM4_Init 2 */
-  HAL_NVIC_SetPriority(TIM4_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(TIM4_IRQn);
+
   /* USER CODE END TIM4_Init 2 */
 }
 
@@ -562,7 +455,7 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *tim_baseHandle) {
     __HAL_RCC_TIM1_CLK_ENABLE();
 
     /* TIM1 interrupt Init */
-    HAL_NVIC_SetPriority(TIM1_CC_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(TIM1_CC_IRQn, IRQ_PRIORITY_PROTOCOL_RX, 0);
     HAL_NVIC_EnableIRQ(TIM1_CC_IRQn);
     /* USER CODE BEGIN TIM1_MspInit 1 */
 
@@ -575,7 +468,7 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *tim_baseHandle) {
     __HAL_RCC_TIM2_CLK_ENABLE();
 
     /* TIM2 interrupt Init */
-    HAL_NVIC_SetPriority(TIM2_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(TIM2_IRQn, IRQ_PRIORITY_SOUND, 0);
     HAL_NVIC_EnableIRQ(TIM2_IRQn);
     /* USER CODE BEGIN TIM2_MspInit 1 */
 
@@ -591,6 +484,8 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *tim_baseHandle) {
     HAL_NVIC_SetPriority(TIM3_IRQn, 0, 0);
     HAL_NVIC_EnableIRQ(TIM3_IRQn);
     /* USER CODE BEGIN TIM3_MspInit 1 */
+    /* TIM3 - старшие 16 бит timebase, прерывания не используются */
+    HAL_NVIC_DisableIRQ(TIM3_IRQn);
 
     /* USER CODE END TIM3_MspInit 1 */
   } else if (tim_baseHandle->Instance == TIM4) {
@@ -601,7 +496,7 @@ void HAL_TIM_Base_MspInit(TIM_HandleTypeDef *tim_baseHandle) {
     __HAL_RCC_TIM4_CLK_ENABLE();
 
     /* TIM4 interrupt Init */
-    HAL_NVIC_SetPriority(TIM4_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(TIM4_IRQn, IRQ_PRIORITY_SCAN, 0);
     HAL_NVIC_EnableIRQ(TIM4_IRQn);
     /* USER CODE BEGIN TIM4_MspInit 1 */
 
@@ -684,38 +579,6 @@ void HAL_TIM_Base_MspDeInit(TIM_HandleTypeDef *tim_baseHandle) {
 
 /* USER CODE BEGIN 1 */
 
-/**
- * @brief  Установка задержки в мс (таймер 3).
- * @param  delay: Значение задержки 1..65535.
- * @retval None
- */
-void TIM3_Delay_ms(uint16_t delay) {
-  is_tim3_period_elapsed = false;
-
-  __HAL_TIM_SET_PRESCALER(&htim3, PRESCALER_FOR_MS);
-  __HAL_TIM_SET_AUTORELOAD(&htim3, delay);
-  HAL_TIM_Base_Start_IT(&htim3);
-  while (!is_tim3_period_elapsed) {
-  }
-  HAL_TIM_Base_Stop_IT(&htim3);
-}
-
-/**
- * @brief  Установка задержки в мкс (таймер 3).
- * @param  delay: Значение задержки 1..65535.
- * @retval None
- */
-void TIM3_Delay_us(uint16_t delay) {
-  is_tim3_period_elapsed = false;
-
-  __HAL_TIM_SET_PRESCALER(&htim3, PRESCALER_FOR_US);
-  __HAL_TIM_SET_AUTORELOAD(&htim3, delay);
-  HAL_TIM_Base_Start_IT(&htim3);
-  while (!is_tim3_period_elapsed) {
-  }
-  HAL_TIM_Base_Stop_IT(&htim3);
-}
-
 /**
  * @brief  Запуск гонга (первый тон).
  * @note   Установка частоты, bip_counter - кол-ва тонов, bip_duration_ms -
@@ -735,51 +598,46 @@ void TIM2_Set_pwm_sound(uint16_t frequency, uint16_t bip_counter,
   // start bip 1
   // TIM2_Start_PWM();
   TIM2_Start_bip(_bip_freq, volume);
-}
 
-/**
- * @brief  Запуск таймера 1 с каналом CH1 Output Compare mode для подсчета
- *         продолжительности тона бузера в мс.
- * @param  None
- * @retval None
- */
-void TIM1_Start() {
-  __HAL_TIM_SET_PRESCALER(&htim1, PRESCALER_FOR_MS); // 1 ms
-  __HAL_TIM_SET_AUTORELOAD(&htim1, 1);               // 1 ms
-  HAL_TIM_OC_Start_IT(&htim1, TIM_CHANNEL_1);
+  // Смена тонов - колесо таймеров (SysTick)
+  gong_tones_elapsed = 0;
+  timer_wheel_start_periodic(&gong_timer, BIP_DURATION_SCALE * bip_duration_ms,
+                             gong_tone_elapsed);
 }
 
 /**
- * @brief  Запуск TIM3 с каналом CH1 для чтения бита данных для протокола
- *         УЛ/УКЛ.
- * @param  prescaler: Значение прескелера (PRESCALER_FOR_US для ukl_timings[],
- *                    PRESCALER_FOR_MS для DELAY_MS_DATA_RECEIVE=200 по
- *                    завершении приема).
- * @param  period:    Значение периода для TIM3.
+ * @brief  Запуск сравнения TIM1 CH1 через delay_us (короткий таймер колеса
+ *         таймеров).
+ * @note   Счетчик TIM1 - младшие 16 бит шкалы времени (timebase.h), поэтому
+ *         он не перезапускается и не останавливается: включается только
+ *         прерывание канала. Флаг сравнения устанавливается и при выключенном
+ *         прерывании, поэтому сбрасывается до записи CCR1: старое совпадение
+ *         не завершает таймер сразу, а совпадение с новым значением сразу
+ *         после записи не теряется.
+ * @param  delay_us: Задержка в мкс 1..65535.
  * @retval None
  */
-void TIM3_Start(uint16_t prescaler, uint16_t period) {
-  __HAL_TIM_SET_PRESCALER(&htim3, prescaler);
-  __HAL_TIM_SET_AUTORELOAD(&htim3, period);
-  HAL_TIM_Base_Start_IT(&htim3);
+void TIM1_Start_compare_us(uint16_t delay_us) {
+  __HAL_TIM_CLEAR_FLAG(&htim1, TIM_FLAG_CC1);
+  __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1,
+                        (uint16_t)(__HAL_TIM_GET_COUNTER(&htim1) + delay_us));
+  __HAL_TIM_ENABLE_IT(&htim1, TIM_IT_CC1);
 }
 
 /**
- * @brief  Остановка таймера 3.
+ * @brief  Остановка сравнения TIM1 CH1.
+ * @note   HAL_TIM_OC_Stop_IT() не используется: без включенных каналов он
+ *         останавливает счетчик TIM1 (шкалу времени).
  * @param  None
  * @retval None
  */
-void TIM3_Stop() { HAL_TIM_Base_Stop_IT(&htim3); }
+void TIM1_Stop_compare() { __HAL_TIM_DISABLE_IT(&htim1, TIM_IT_CC1); }
 
 /**
  * @brief  Запуск TIM4 на 1 мс.
- * @note   Используется:
- *         1. для отображения символов (яркость, удержание строки в течение 1
- *            мс);
- *         2. для отображения строк в течение TIME_DISPLAY_STRING_DURING_MS;
- *         3. для контроля подключения интерфейса (CAN, USART);
- *         4. для проверки бездействия кнопок в течение TIME_MS_FOR_SETTINGS в
- *            режиме меню.
+ * @note   Используется для отображения символов (яркость, удержание строки в
+ *         течение 1 мс, граница строки развертки). Остальные отсчеты времени -
+ *         колесо таймеров (timer_wheel.h).
  * @param  None
  * @retval None
  */
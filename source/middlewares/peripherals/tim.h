@@ -29,16 +29,17 @@ extern TIM_HandleTypeDef htim3;
 extern TIM_HandleTypeDef htim4;
 
 /* USER CODE BEGIN Private defines */
-#define TIM2_FREQ 64000000  ///< Частота линии APB1 для TIM2
-#define TIM3_FREQ TIM2_FREQ ///< Частота линии APB1 для TIM3
+#define TIM1_FREQ TIM_APB2_FREQ ///< Частота таймеров APB2 для TIM1
+#define TIM2_FREQ TIM_APB1_FREQ ///< Частота таймеров APB1 для TIM2
+#define TIM3_FREQ TIM2_FREQ     ///< Частота таймеров APB1 для TIM3
 
 #define FREQ_FOR_MS 1000    ///< Частота для 1 мс
 #define FREQ_FOR_US 1000000 ///< Частота для 1 мкс
 
-#define PRESCALER_FOR_MS                                                       \
-  TIM3_FREQ / FREQ_FOR_MS - 1 ///< Прескелер для таймера в 1 мс
 #define PRESCALER_FOR_US                                                       \
-  TIM3_FREQ / FREQ_FOR_US - 1 ///< Прескелер для таймера в 1 мкс
+  (TIM3_FREQ / FREQ_FOR_US - 1) ///< Прескелер для таймеров APB1 в 1 мкс
+#define TIM1_PRESCALER_FOR_US                                                  \
+  (TIM1_FREQ / FREQ_FOR_US - 1) ///< Прескелер для TIM1 в 1 мкс
 
 /* USER CODE END Private defines */
 
@@ -53,20 +54,6 @@ void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
 
 /* USER CODE BEGIN Prototypes */
 
-/**
- * @brief  Установка задержки в мс (таймер 3).
- * @param  delay: Значение задержки 1..65535.
- * @retval None
- */
-void TIM3_Delay_ms(uint16_t delay);
-
-/**
- * @brief  Установка задержки в мкс (таймер 3).
- * @param  delay: Значение задержки 1..65535.
- * @retval None
- */
-void TIM3_Delay_us(uint16_t delay);
-
 /**
  * @brief  Включение тона пассивного бузера (подключен к таймеру 2).
  * @param  frequency: Значение частоты 1..65535.
@@ -82,22 +69,27 @@ void TIM2_Start_bip(uint16_t frequency, uint8_t volume);
 void TIM2_Stop_bip();
 
 /**
- * @brief  Запуск таймера 1 с каналом CH1 Output Compare mode для подсчета
- *         продолжительности тона бузера в мс.
+ * @brief  Запуск сравнения TIM1 CH1 через delay_us (короткий таймер колеса
+ *         таймеров).
+ * @note   Счетчик TIM1 - младшие 16 бит шкалы времени (timebase.h), поэтому
+ *         он не перезапускается и не останавливается.
+ * @param  delay_us: Задержка в мкс 1..65535.
+ * @retval None
+ */
+void TIM1_Start_compare_us(uint16_t delay_us);
+
+/**
+ * @brief  Остановка сравнения TIM1 CH1.
  * @param  None
  * @retval None
  */
-void TIM1_Start();
+void TIM1_Stop_compare();
 
 /**
  * @brief  Запуск TIM4 на 1 мс.
- * @note   Используется:
- *         1. для отображения символов (яркость, удержание строки в течение 1
- *            мс);
- *         2. для отображения строк в течение TIME_DISPLAY_STRING_DURING_MS;
- *         3. для контроля подключения интерфейса (CAN, USART);
- *         4. для проверки бездействия кнопок в течение TIME_MS_FOR_SETTINGS в
- *            режиме меню.
+ * @note   Используется для отображения символов (яркость, удержание строки в
+ *         течение 1 мс, граница строки развертки). Остальные отсчеты времени -
+ *         колесо таймеров (timer_wheel.h).
  * @param  None
  * @retval None
  */
@@ -116,26 +108,7 @@ void TIM2_Set_pwm_sound(uint16_t frequency, uint16_t bip_counter,
                         uint16_t bip_duration_ms, uint8_t volume);
 
 /**
- * @brief  Запуск TIM3 с каналом CH1 для чтения бита данных для протокола
- *         УЛ/УКЛ.
- * @param  prescaler: Значение прескелера (PRESCALER_FOR_US для ukl_timings[],
- *                    PRESCALER_FOR_MS для DELAY_MS_DATA_RECEIVE=200 по
- *                    завершении приема).
- * @param  period:    Значение периода для TIM3.
- * @retval None
- */
-void TIM3_Start(uint16_t prescaler, uint16_t period);
-
-/**
- * @brief  Остановка таймера 3.
- * @param  None
- * @retval None
- */
-void TIM3_Stop();
-
-/**
- * @brief  Выключение бузера (ШИМ TIM2 и TIM1 для подсчета продолжительности
- *         тона бузера).
+ * @brief  Выключение бузера (ШИМ TIM2 и таймер смены тонов гонга).
  * @param  None
  * @retval None
  */
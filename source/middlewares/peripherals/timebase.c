@@ -0,0 +1,55 @@
+/**
+ * @file timebase.c
+ */
+#include "timebase.h"
+
+#include "tim.h"
+
+/**
+ * @brief  Запуск шкалы времени 1 мкс (32 бит): TIM1 - младшие 16 бит, TIM3 -
+ *         старшие 16 бит (счет переполнений TIM1 по ITR0).
+ * @note   Сначала запускается TIM3, чтобы первое переполнение TIM1 не было
+ *         пропущено. Счетчик TIM1 больше не останавливается: каналы TIM1
+ *         включаются и выключаются без остановки счетчика (tim.c).
+ * @param  None
+ * @retval None
+ */
+void timebase_start(void) {
+  __HAL_TIM_SET_COUNTER(&htim3, 0);
+  __HAL_TIM_SET_COUNTER(&htim1, 0);
+  HAL_TIM_Base_Start(&htim3);
+  HAL_TIM_Base_Start(&htim1);
+}
+
+/**
+ * @brief  Текущее время в мкс (без блокировки, можно вызывать из прерывания).
+ * @note   Младшая половина читается до и после старшей: если второе
+ *         значение TIM1 меньше первого, между чтениями было переполнение и
+ *         чтение повторяется. При TIM1 = 0 чтение тоже повторяется: TIM3
+ *         считает переполнение по ITR0 с задержкой синхронизации, в первую
+ *         мкс после переполнения старшая половина может быть прежней.
+ *         Прерывания не запрещаются, повтор - не дольше 1 мкс и не чаще
+ *         одного раза за 65.5 мс.
+ * @param  None
+ * @retval Время в мкс от timebase_start().
+ */
+uint32_t timebase_now_us(void) {
+  uint16_t high;
+  uint16_t low;
+
+  do {
+    low = __HAL_TIM_GET_COUNTER(&htim1);
+    high = __HAL_TIM_GET_COUNTER(&htim3);
+  } while (low == 0 || (uint16_t)__HAL_TIM_GET_COUNTER(&htim1) < low);
+
+  return ((uint32_t)high << 16) | low;
+}
+
+/**
+ * @brief  Время, прошедшее с момента start_us, в мкс.
+ * @param  start_us: Момент начала (timebase_now_us()).
+ * @retval Интервал в мкс.
+ */
+uint32_t timebase_elapsed_us(uint32_t start_us) {
+  return timebase_now_us() - start_us;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file    timebase.h
+ * @brief   Этот файл содержит прототипы функций для файла timebase.c
+ */
+#ifndef __TIMEBASE_H__
+#define __TIMEBASE_H__
+
+#include <stdint.h>
+
+/**
+ * @brief  Запуск шкалы времени 1 мкс (32 бит): TIM1 - младшие 16 бит, TIM3 -
+ *         старшие 16 бит (счет переполнений TIM1 по ITR0).
+ * @note   Вызывается один раз после MX_TIM1_Init() и MX_TIM3_Init().
+ * @param  None
+ * @retval None
+ */
+void timebase_start(void);
+
+/**
+ * @brief  Текущее время в мкс (без блокировки, можно вызывать из прерывания).
+ * @note   Переполнение - через 2^32 мкс (~71.6 мин): интервал считается
+ *         вычитанием (now - start) в uint32_t.
+ * @param  None
+ * @retval Время в мкс от timebase_start().
+ */
+uint32_t timebase_now_us(void);
+
+/**
+ * @brief  Время, прошедшее с момента start_us, в мкс.
+ * @param  start_us: Момент начала (timebase_now_us()).
+ * @retval Интервал в мкс.
+ */
+uint32_t timebase_elapsed_us(uint32_t start_us);
+
+#endif /* __TIMEBASE_H__ */
@@ -0,0 +1,265 @@
+/**
+ * @file timer_wheel.c
+ */
+#include "timer_wheel.h"
+
+#include "tim.h"
+
+#include <stddef.h>
+
+#define L0_SIZE (1UL << TIMER_WHEEL_L0_BITS) ///< Кол-во ячеек уровня 0
+#define L1_SIZE (1UL << TIMER_WHEEL_L1_BITS) ///< Кол-во ячеек уровня 1
+#define L0_MASK (L0_SIZE - 1)                ///< Маска индекса уровня 0
+#define L1_MASK (L1_SIZE - 1)                ///< Маска индекса уровня 1
+
+/// Ячейки уровня 0 (срабатывание в пределах L0_SIZE мс).
+static timer_wheel_timer_t *wheel_l0[L0_SIZE];
+
+/// Ячейки уровня 1 (переносятся на уровень 0 в начале своего интервала).
+static timer_wheel_timer_t *wheel_l1[L1_SIZE];
+
+/// Текущий тик колеса в мс.
+static volatile uint32_t wheel_ms = 0;
+
+/// Колбек короткого таймера (NULL - короткий таймер не ожидает).
+static volatile timer_wheel_callback_t us_callback = NULL;
+
+/**
+ * @brief  Добавление таймера в ячейку.
+ * @param  slot:  Указатель на ячейку (голову списка).
+ * @param  timer: Указатель на таймер.
+ * @retval None
+ */
+static void link_timer(timer_wheel_timer_t **slot, timer_wheel_timer_t *timer) {
+  timer->next = *slot;
+  if (timer->next != NULL) {
+    timer->next->pprev = &timer->next;
+  }
+  timer->pprev = slot;
+  *slot = timer;
+}
+
+/**
+ * @brief  Удаление таймера из ячейки (без поиска, по ссылке pprev).
+ * @param  timer: Указатель на таймер.
+ * @retval None
+ */
+static void unlink_timer(timer_wheel_timer_t *timer) {
+  *timer->pprev = timer->next;
+  if (timer->next != NULL) {
+    timer->next->pprev = timer->pprev;
+  }
+  timer->next = NULL;
+  timer->pprev = NULL;
+}
+
+/**
+ * @brief  Размещение таймера в ячейке по времени до срабатывания.
+ * @note   1. До L0_SIZE мс - ячейка уровня 0 с индексом младших бит
+ *            expires_ms;
+ *         2. До L0_SIZE * L1_SIZE мс - ячейка уровня 1 с индексом следующих
+ *            бит expires_ms;
+ *         3. Дальше - последняя ячейка уровня 1: при переносе таймер
+ *            размещается заново.
+ *         Вызывается при запрещенных прерываниях.
+ * @param  timer: Указатель на таймер.
+ * @retval None
+ */
+static void insert_timer(timer_wheel_timer_t *timer) {
+  uint32_t delta_ms = timer->expires_ms - wheel_ms;
+
+  if (delta_ms < L0_SIZE) {
+    link_timer(&wheel_l0[timer->expires_ms & L0_MASK], timer);
+  } else if (delta_ms < L0_SIZE * L1_SIZE) {
+    uint32_t index = (timer->expires_ms >> TIMER_WHEEL_L0_BITS) & L1_MASK;
+    link_timer(&wheel_l1[index], timer);
+  } else {
+    uint32_t index = ((wheel_ms >> TIMER_WHEEL_L0_BITS) + L1_MASK) & L1_MASK;
+    link_timer(&wheel_l1[index], timer);
+  }
+}
+
+/**
+ * @brief  Запуск таймера: срабатывание через delay_ms, затем - с периодом
+ *         period_ms (0 - однократно).
+ * @param  timer:     Указатель на таймер.
+ * @param  delay_ms:  Задержка до первого срабатывания в мс.
+ * @param  period_ms: Период в мс.
+ * @param  callback:  Колбек срабатывания.
+ * @retval None
+ */
+static void start_timer(timer_wheel_timer_t *timer, uint32_t delay_ms,
+                        uint32_t period_ms, timer_wheel_callback_t callback) {
+  __disable_irq();
+  if (timer->pprev != NULL) {
+    unlink_timer(timer);
+  }
+  timer->callback = callback;
+  timer->period_ms = period_ms;
+  timer->expires_ms = wheel_ms + (delay_ms != 0 ? delay_ms : 1);
+  insert_timer(timer);
+  __enable_irq();
+}
+
+/**
+ * @brief  Запуск однократного таймера (перезапуск, если таймер запущен).
+ * @param  timer:    Указатель на таймер.
+ * @param  delay_ms: Задержка в мс (0 - на следующем тике).
+ * @param  callback: Колбек срабатывания.
+ * @retval None
+ */
+void timer_wheel_start_once(timer_wheel_timer_t *timer, uint32_t delay_ms,
+                            timer_wheel_callback_t callback) {
+  start_timer(timer, delay_ms, 0, callback);
+}
+
+/**
+ * @brief  Запуск периодического таймера (перезапуск, если таймер запущен).
+ * @param  timer:     Указатель на таймер.
+ * @param  period_ms: Период в мс (первое срабатывание через период).
+ * @param  callback:  Колбек срабатывания.
+ * @retval None
+ */
+void timer_wheel_start_periodic(timer_wheel_timer_t *timer, uint32_t period_ms,
+                                timer_wheel_callback_t callback) {
+  start_timer(timer, period_ms, period_ms, callback);
+}
+
+/**
+ * @brief  Остановка таймера (можно вызывать из колбека таймера).
+ * @param  timer: Указатель на таймер.
+ * @retval None
+ */
+void timer_wheel_stop(timer_wheel_timer_t *timer) {
+  __disable_irq();
+  if (timer->pprev != NULL) {
+    unlink_timer(timer);
+  }
+  __enable_irq();
+}
+
+/**
+ * @brief  Проверка, запущен ли таймер.
+ * @param  timer: Указатель на таймер.
+ * @retval true, если таймер ожидает срабатывания.
+ */
+bool timer_wheel_is_active(const timer_wheel_timer_t *timer) {
+  return timer->pprev != NULL;
+}
+
+/**
+ * @brief  Перенос ячейки уровня 1 на уровень 0 (в начале интервала ячейки).
+ * @note   Вызывается при запрещенных прерываниях.
+ * @param  None
+ * @retval None
+ */
+static void cascade_l1() {
+  uint32_t index = (wheel_ms >> TIMER_WHEEL_L0_BITS) & L1_MASK;
+  timer_wheel_timer_t *timer = wheel_l1[index];
+
+  wheel_l1[index] = NULL;
+  while (timer != NULL) {
+    timer_wheel_timer_t *next = timer->next;
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    insert_timer(timer);
+    timer = next;
+  }
+}
+
+/**
+ * @brief  Тик колеса таймеров (вызывается каждую мс из SysTick_Handler).
+ * @note   1. В начале интервала уровня 1 его ячейка переносится на уровень 0;
+ *         2. Ячейка уровня 0 текущего тика отделяется от колеса, таймеры
+ *            срабатывают по одному: periodic размещается заново до вызова
+ *            колбека, поэтому колбек может остановить или перезапустить свой
+ *            таймер. Колбеки выполняются при разрешенных прерываниях.
+ *         Вставка, удаление и срабатывание - O(1), перенос - O(1) на таймер.
+ * @param  None
+ * @retval None
+ */
+void timer_wheel_tick(void) {
+  timer_wheel_timer_t *expired = NULL;
+
+  __disable_irq();
+  wheel_ms++;
+  if ((wheel_ms & L0_MASK) == 0) {
+    cascade_l1();
+  }
+
+  /* Отделение ячейки: остановка таймера в колбеке удаляет его из expired */
+  timer_wheel_timer_t **slot = &wheel_l0[wheel_ms & L0_MASK];
+  expired = *slot;
+  *slot = NULL;
+  if (expired != NULL) {
+    expired->pprev = &expired;
+  }
+  __enable_irq();
+
+  while (1) {
+    __disable_irq();
+    timer_wheel_timer_t *timer = expired;
+    if (timer == NULL) {
+      __enable_irq();
+      break;
+    }
+
+    unlink_timer(timer);
+    timer_wheel_callback_t callback = timer->callback;
+    if (timer->period_ms != 0) {
+      timer->expires_ms += timer->period_ms;
+      insert_timer(timer);
+    }
+    __enable_irq();
+
+    if (callback != NULL) {
+      callback();
+    }
+  }
+}
+
+/**
+ * @brief  Запуск короткого таймера с разрешением 1 мкс (сравнение TIM1 CH1).
+ * @note   Одновременно ожидает один короткий таймер.
+ * @param  delay_us: Задержка в мкс 1..65535.
+ * @param  callback: Колбек срабатывания (из прерывания TIM1).
+ * @retval true, если таймер запущен; false - короткий таймер уже ожидает.
+ */
+bool timer_wheel_start_us(uint16_t delay_us, timer_wheel_callback_t callback) {
+  __disable_irq();
+  if (us_callback != NULL) {
+    __enable_irq();
+    return false;
+  }
+  us_callback = callback;
+  __enable_irq();
+
+  TIM1_Start_compare_us(delay_us != 0 ? delay_us : 1);
+  return true;
+}
+
+/**
+ * @brief  Остановка короткого таймера.
+ * @param  None
+ * @retval None
+ */
+void timer_wheel_stop_us(void) {
+  TIM1_Stop_compare();
+  us_callback = NULL;
+}
+
+/**
+ * @brief  Срабатывание короткого таймера (вызывается из прерывания сравнения
+ *         TIM1 CH1).
+ * @param  None
+ * @retval None
+ */
+void timer_wheel_us_elapsed(void) {
+  timer_wheel_callback_t callback = us_callback;
+
+  timer_wheel_stop_us();
+  if (callback != NULL) {
+    callback();
+  }
+}
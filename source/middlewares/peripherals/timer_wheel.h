@@ -0,0 +1,94 @@
+/**
+ * @file    timer_wheel.h
+ * @brief   Этот файл содержит прототипы функций для файла timer_wheel.c
+ */
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMER_WHEEL_L0_BITS 8 ///< Уровень 0: 256 ячеек по 1 мс
+#define TIMER_WHEEL_L1_BITS 6 ///< Уровень 1: 64 ячейки по 256 мс (16.3 с)
+
+/// Колбек программного таймера (вызывается из прерывания SysTick или TIM1).
+typedef void (*timer_wheel_callback_t)(void);
+
+/**
+ * Программный таймер (память - у владельца, обычно static). Нулевая
+ * структура - остановленный таймер.
+ */
+typedef struct timer_wheel_timer {
+  struct timer_wheel_timer *next;   // Следующий таймер в ячейке
+  struct timer_wheel_timer **pprev; // Ссылка на таймер в ячейке, NULL - стоп
+  uint32_t expires_ms;              // Время срабатывания (тик колеса)
+  uint32_t period_ms;               // Период в мс, 0 - однократный таймер
+  timer_wheel_callback_t callback;  // Колбек срабатывания
+} timer_wheel_timer_t;
+
+/**
+ * @brief  Запуск однократного таймера (перезапуск, если таймер запущен).
+ * @param  timer:    Указатель на таймер.
+ * @param  delay_ms: Задержка в мс (0 - на следующем тике).
+ * @param  callback: Колбек срабатывания.
+ * @retval None
+ */
+void timer_wheel_start_once(timer_wheel_timer_t *timer, uint32_t delay_ms,
+                            timer_wheel_callback_t callback);
+
+/**
+ * @brief  Запуск периодического таймера (перезапуск, если таймер запущен).
+ * @param  timer:     Указатель на таймер.
+ * @param  period_ms: Период в мс (первое срабатывание через период).
+ * @param  callback:  Колбек срабатывания.
+ * @retval None
+ */
+void timer_wheel_start_periodic(timer_wheel_timer_t *timer, uint32_t period_ms,
+                                timer_wheel_callback_t callback);
+
+/**
+ * @brief  Остановка таймера (можно вызывать из колбека таймера).
+ * @param  timer: Указатель на таймер.
+ * @retval None
+ */
+void timer_wheel_stop(timer_wheel_timer_t *timer);
+
+/**
+ * @brief  Проверка, запущен ли таймер.
+ * @param  timer: Указатель на таймер.
+ * @retval true, если таймер ожидает срабатывания.
+ */
+bool timer_wheel_is_active(const timer_wheel_timer_t *timer);
+
+/**
+ * @brief  Тик колеса таймеров (вызывается каждую мс из SysTick_Handler).
+ * @param  None
+ * @retval None
+ */
+void timer_wheel_tick(void);
+
+/**
+ * @brief  Запуск короткого таймера с разрешением 1 мкс (сравнение TIM1 CH1).
+ * @note   Одновременно ожидает один короткий таймер.
+ * @param  delay_us: Задержка в мкс 1..65535.
+ * @param  callback: Колбек срабатывания (из прерывания TIM1).
+ * @retval true, если таймер запущен; false - короткий таймер уже ожидает.
+ */
+bool timer_wheel_start_us(uint16_t delay_us, timer_wheel_callback_t callback);
+
+/**
+ * @brief  Остановка короткого таймера.
+ * @param  None
+ * @retval None
+ */
+void timer_wheel_stop_us(void);
+
+/**
+ * @brief  Срабатывание короткого таймера (вызывается из прерывания сравнения
+ *         TIM1 CH1).
+ * @param  None
+ * @retval None
+ */
+void timer_wheel_us_elapsed(void);
+
+#endif /* __TIMER_WHEEL_H__ */
@@ -0,0 +1,139 @@
+/**
+ * @file watchdog.c
+ */
+#include "watchdog.h"
+
+#include "main.h"
+
+#define IWDG_KEY_RELOAD 0xAAAAU ///< Перезапуск счетчика IWDG
+#define IWDG_KEY_ENABLE 0xCCCCU ///< Запуск IWDG
+#define IWDG_KEY_ACCESS 0x5555U ///< Доступ к IWDG_PR и IWDG_RLR
+#define IWDG_PRESCALER_DIV 64   ///< Делитель LSI
+#define IWDG_PR_DIV64 4U        ///< Значение IWDG_PR для делителя 64
+#define IWDG_RELOAD                                                            \
+  (LSI_VALUE / IWDG_PRESCALER_DIV * WATCHDOG_TIMEOUT_MS / 1000 - 1)
+
+_Static_assert(IWDG_RELOAD > 0 && IWDG_RELOAD <= IWDG_RLR_RL,
+               "WATCHDOG_TIMEOUT_MS does not fit IWDG reload (prescaler 64)");
+
+#define RESET_RECORD_MAGIC 0x5EC0DE01UL ///< Признак записи в .noinit RAM
+
+/**
+ * Запись о перезапусках (.noinit RAM сохраняется при перезапуске, см. .ld).
+ */
+typedef struct {
+  uint32_t magic;       // RESET_RECORD_MAGIC, иначе запись не определена
+  uint8_t pending_mask; // Задачи, не отметившиеся после перезапуска IWDG
+  reset_info_t info;    // Причина последнего перезапуска
+} reset_record_t;
+
+/// Запись о перезапусках (в NOINIT после запроса загрузчика, см. .ld).
+static reset_record_t record
+    __attribute__((__section__(".noinit.reset"), used));
+
+/// Маска задач под контролем IWDG (0 - IWDG не запущен).
+static uint8_t supervised = 0;
+
+/**
+ * @brief  Причина перезапуска по флагам RCC_CSR.
+ * @note   Флаг NRST устанавливается при любом перезапуске, поэтому
+ *         проверяется последним.
+ * @param  None
+ * @retval Причина fw_reset_cause_t.
+ */
+static fw_reset_cause_t read_reset_cause(void) {
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST)) {
+    return FW_RESET_WATCHDOG;
+  }
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_WWDGRST)) {
+    return FW_RESET_WWDG;
+  }
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_LPWRRST)) {
+    return FW_RESET_LOW_POWER;
+  }
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_PORRST)) {
+    return FW_RESET_POWER;
+  }
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_SFTRST)) {
+    return FW_RESET_SOFTWARE;
+  }
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_PINRST)) {
+    return FW_RESET_PIN;
+  }
+  return FW_RESET_UNKNOWN;
+}
+
+/**
+ * @brief  Определение причины перезапуска по флагам RCC_CSR и сброс флагов.
+ * @note   1. Вызывается один раз при запуске, до watchdog_start();
+ *         2. Загрузчик флаги не сбрасывает: переход из загрузчика в
+ *            приложение не меняет причину перезапуска;
+ *         3. При сбросе IWDG маска задач, не отметившихся до сброса,
+ *            сохраняется в hung_mask.
+ * @param  None
+ * @retval None
+ */
+void watchdog_record_reset_cause(void) {
+  fw_reset_cause_t cause = read_reset_cause();
+  __HAL_RCC_CLEAR_RESET_FLAGS();
+
+  if (record.magic != RESET_RECORD_MAGIC || cause == FW_RESET_POWER) {
+    record = (reset_record_t){.magic = RESET_RECORD_MAGIC};
+  }
+
+  record.info.cause = cause;
+  record.info.hung_mask = 0;
+  if (cause == FW_RESET_WATCHDOG) {
+    record.info.hung_mask = record.pending_mask;
+    record.info.watchdog_resets++;
+  }
+  record.pending_mask = 0;
+}
+
+/**
+ * @brief  Запуск IWDG: сброс через WATCHDOG_TIMEOUT_MS, если хотя бы одна из
+ *         задач supervised_mask не отметилась (watchdog_checkin()).
+ * @note   Остановить IWDG можно только перезапуском. При остановке ядра
+ *         отладчиком IWDG останавливается.
+ * @param  supervised_mask: Маска задач под контролем (бит - номер задачи).
+ * @retval None
+ */
+void watchdog_start(uint8_t supervised_mask) {
+  supervised = supervised_mask;
+  record.pending_mask = supervised_mask;
+
+  __HAL_DBGMCU_FREEZE_IWDG();
+
+  IWDG->KR = IWDG_KEY_ENABLE;
+  IWDG->KR = IWDG_KEY_ACCESS;
+  IWDG->PR = IWDG_PR_DIV64;
+  IWDG->RLR = IWDG_RELOAD;
+  while (IWDG->SR != 0) { // Запись PR и RLR в домен LSI
+  }
+  IWDG->KR = IWDG_KEY_RELOAD;
+}
+
+/**
+ * @brief  Отметка задачи (задача выполнилась). Перезапуск IWDG, когда
+ *         отметились все задачи под контролем.
+ * @note   Вызывается из главного цикла (не из прерывания). Маска
+ *         неотметившихся задач хранится в .noinit: после сброса IWDG она
+ *         указывает на зависшую задачу.
+ * @param  task: Номер задачи.
+ * @retval None
+ */
+void watchdog_checkin(uint8_t task) {
+  record.pending_mask &= ~(1U << task);
+
+  if (supervised != 0 && record.pending_mask == 0) {
+    IWDG->KR = IWDG_KEY_RELOAD;
+    record.pending_mask = supervised;
+  }
+}
+
+/**
+ * @brief  Получение причины последнего перезапуска.
+ * @param  info: Указатель на структуру для копирования.
+ * @retval None
+ */
+void watchdog_get_reset_info(reset_info_t *info) { *info = record.info; }
@@ -0,0 +1,57 @@
+/**
+ * @file    watchdog.h
+ * @brief   Этот файл содержит прототипы функций для файла watchdog.c
+ */
+#ifndef __WATCHDOG_H__
+#define __WATCHDOG_H__
+
+#include "fw_update_protocol.h"
+
+#include <stdint.h>
+
+#define WATCHDOG_TIMEOUT_MS                                                    \
+  500 ///< Время без отметок всех задач до сброса IWDG (LSI 40 кГц, +-50 %)
+
+/**
+ * Причина последнего перезапуска (сохраняется в .noinit RAM).
+ */
+typedef struct {
+  fw_reset_cause_t cause;   // Причина перезапуска (флаги RCC_CSR)
+  uint8_t hung_mask;        // Задачи, не отметившиеся перед сбросом IWDG
+  uint16_t watchdog_resets; // Кол-во сбросов IWDG после включения питания
+} reset_info_t;
+
+/**
+ * @brief  Определение причины перезапуска по флагам RCC_CSR и сброс флагов.
+ * @note   Вызывается один раз при запуске, до watchdog_start().
+ * @param  None
+ * @retval None
+ */
+void watchdog_record_reset_cause(void);
+
+/**
+ * @brief  Запуск IWDG: сброс через WATCHDOG_TIMEOUT_MS, если хотя бы одна из
+ *         задач supervised_mask не отметилась (watchdog_checkin()).
+ * @note   Остановить IWDG можно только перезапуском.
+ * @param  supervised_mask: Маска задач под контролем (бит - номер задачи).
+ * @retval None
+ */
+void watchdog_start(uint8_t supervised_mask);
+
+/**
+ * @brief  Отметка задачи (задача выполнилась). Перезапуск IWDG, когда
+ *         отметились все задачи под контролем.
+ * @note   Вызывается из главного цикла (не из прерывания).
+ * @param  task: Номер задачи.
+ * @retval None
+ */
+void watchdog_checkin(uint8_t task);
+
+/**
+ * @brief  Получение причины последнего перезапуска.
+ * @param  info: Указатель на структуру для копирования.
+ * @retval None
+ */
+void watchdog_get_reset_info(reset_info_t *info);
+
+#endif /* __WATCHDOG_H__ */
@@ -33,7 +33,7 @@ static void display_symbols(uint8_t floor, directionType direction) {
   drawing_data_t drawing_data = {0, 0};
 
   drawing_data_setter(&drawing_data, floor, direction);
-  setting_symbols(matrix_string, &drawing_data, floor, NULL, 0);
+  setting_symbols(matrix_string, &drawing_data, floor);
   display_symbols_during_ms(matrix_string);
 }
 
@@ -3,6 +3,7 @@
  */
 #include "test_mode.h"
 
+#include "async_delay.h"
 #include "buzzer.h"
 #include "can.h"
 #include "dot.h"
@@ -19,20 +20,28 @@ static uint8_t current_col = 0;
 /// Индекс текущей строки в цикле.
 static uint8_t current_row = 0;
 
+/// Последовательность заполнения матрицы (set_matrix_by_rows()).
+static async_t fill_async = {0, 0};
+
+/// Последовательность тестового режима (run_test_sequence()).
+static async_t test_async = {0, 0};
+
 /**
  * @brief  Поочерёдно включает каждый светодиод на матрице, постепенно включая
  *         её полностью.
+ * @note   Не блокирует: вызывается повторно до возврата true.
  * @param  None
- * @retval None
+ * @retval true, если матрица заполнена.
  */
-static void set_matrix_by_rows() {
+static bool set_matrix_by_rows() {
+  ASYNC_BEGIN(&fill_async);
   while (current_row < ROWS) {
     set_all_cols_state(TURN_OFF);
 
     set_row_state(current_row, TURN_ON);
     while (current_col < COLUMNS) {
       set_col_state(current_col, TURN_ON);
-      TIM3_Delay_ms(100);
+      ASYNC_DELAY_MS(&fill_async, 100);
       current_col++;
     }
 
@@ -43,42 +52,62 @@ static void set_matrix_by_rows() {
     current_row++;
     current_col = 0;
   }
+  ASYNC_END(&fill_async);
 }
 
-/// Флаг для проверки, получены ли данные по CAN
-extern volatile bool is_data_received;
-
 /**
- * @brief  Запуск тестового режима (проверка светодиодов матрицы, CAN и бузера).
- * @retval
+ * @brief  Последовательность проверки матрицы и бузера, затем запуск CAN в
+ *         режиме loopback.
+ * @note   Не блокирует: вызывается повторно до возврата true, задержки -
+ *         ASYNC_DELAY_MS().
+ * @param  None
+ * @retval true, если последовательность завершена.
  */
-void test_mode_start() {
+static bool run_test_sequence() {
+  ASYNC_BEGIN(&test_async);
 
   /* Построчное заполнение матрицы (включение светодиодов) */
-  set_matrix_by_rows();
-  TIM3_Delay_ms(500);
+  ASYNC_AWAIT(&test_async, set_matrix_by_rows());
+  ASYNC_DELAY_MS(&test_async, 500);
 
   /* Выключение и включение матрицы */
   set_full_matrix_state(TURN_OFF);
-  TIM3_Delay_ms(1000);
+  ASYNC_DELAY_MS(&test_async, 1000);
   set_full_matrix_state(TURN_ON);
 
   /* Включение пассивного бузера (воспроизведение гонга из 3-х частот: 1000,
    * 900, 800 Гц) с максимальной громкостью */
-  play_gong(3, 1000, VOLUME_3);
+  play_gong(3, 1000, VOLUME_3, BIP_DURATION_GONG);
 
-  TIM3_Delay_ms(1000);
+  ASYNC_DELAY_MS(&test_async, 1000);
   set_full_matrix_state(TURN_OFF);
-  TIM3_Delay_ms(1000);
+  ASYNC_DELAY_MS(&test_async, 1000);
 
   /* Отправка данных по CAN в режиме loopback */
   MX_CAN_Init();
   start_can(&hcan, TEST_MODE_STD_ID);
   CAN_TxData(TEST_MODE_STD_ID);
 
-  /* Отображение строки, если данные получены */
+  ASYNC_END(&test_async);
+}
+
+/// Флаг для проверки, получены ли данные по CAN
+extern volatile bool is_data_received;
+
+/**
+ * @brief  Запуск тестового режима (проверка светодиодов матрицы, CAN и бузера).
+ * @note   Шаги проверки выполняются без блокирующих задержек
+ *         (run_test_sequence()), после завершения отображается строка, если
+ *         данные по CAN получены.
+ * @retval
+ */
+void test_mode_start() {
+  bool is_sequence_done = false;
+
   while (1) {
-    if (is_data_received) {
+    if (!is_sequence_done) {
+      is_sequence_done = run_test_sequence();
+    } else if (is_data_received) {
       draw_string_on_matrix(str_ok);
     }
   }
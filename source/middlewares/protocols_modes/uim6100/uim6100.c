@@ -3,10 +3,11 @@
  */
 #include "uim6100.h"
 
-#include "buzzer.h"
 #include "config.h"
 #include "drawing.h"
-#include "tim.h"
+#include "floor_labels.h"
+#include "sound.h"
+#include "timebase.h"
 
 #include <stdbool.h>
 
@@ -19,14 +20,14 @@
 
 #define CODE_FLOOR_W_2_MASK 0x3F ///< Маска для номера этажа
 
-#define GONG_BUZZER_FREQ 1000 ///< Частота первого тона гонга
-#define BUZZER_FREQ_CABIN_OVERLOAD                                             \
-  3000 ///< Частота для тона бузера при перегрузе кабины VOICE_CABIN_OVERLOAD
-#define BUZZER_FREQ_FIRE_DANGER                                                \
-  BUZZER_FREQ_CABIN_OVERLOAD ///< Частота для тона бузера при пожарной опасности
-                             ///< VOICE_FIRE_DANGER
-
-#define SPECIAL_SYMBOLS_BUFF_SIZE 19 ///< Кол-во спец. символов
+#define UIM6100_CODE_OPERATION_DATA 0x81 ///< Код операции: данные индикации
+#define UIM6100_CODE_OPERATION_POLL 0x82 ///< Код операции: опрос индикатора
+#define UIM6100_NO_ANSWER_MASK                                                 \
+  0x80 ///< Бит в байте W3: ответ на кадр не требуется
+#define UIM6100_ANSWER_ID_OFFSET 0x80 ///< ID ответа: адрес + смещение
+#define UIM6100_NO_SOUND_ID 49 ///< Адрес индикатора без звуков
+#define UIM6100_GONG_ALWAYS_ID                                                 \
+  47 ///< Адрес этажного индикатора, воспроизводящего гонг на всех этажах
 
 /**
  * Индексы байтов в сообщении UIM6100.
@@ -89,431 +90,448 @@ typedef enum CODE_FLOOR {
   LOADING = 59
 } code_floor_t;
 
-/// Буфер со спец. символами
-static const code_location_symbols_t
-    special_symbols_code_location[SPECIAL_SYMBOLS_BUFF_SIZE] = {
-        {.code_location = RESERVE, .symbols = "b"},
-        {.code_location = SEISMIC_DANGER, .symbols = "L"},
-        {.code_location = LIFT_NOT_WORK, .symbols = "A"},
-        {.code_location = TRANSFER_FIREFIGHTERS, .symbols = "P"},
-        {.code_location = CODE_FLOOR_54, .symbols = "H"},
-        {.code_location = SERVICE, .symbols = "C"},
-        {.code_location = EVACUATION, .symbols = "E"},
-        {.code_location = FIRE_DANGER, .symbols = "F"},
-        {.code_location = FAULT_IBP, .symbols = "U"},
-        {.code_location = LOADING, .symbols = "p"},
-        {.code_location = FLOOR_MINUS_1, .symbols = "-1"},
-        {.code_location = FLOOR_MINUS_2, .symbols = "-2"},
-        {.code_location = FLOOR_MINUS_3, .symbols = "-3"},
-        {.code_location = FLOOR_MINUS_4, .symbols = "-4"},
-        {.code_location = FLOOR_MINUS_5, .symbols = "-5"},
-        {.code_location = FLOOR_MINUS_6, .symbols = "-6"},
-        {.code_location = FLOOR_MINUS_7, .symbols = "-7"},
-        {.code_location = FLOOR_MINUS_8, .symbols = "-8"},
-        {.code_location = FLOOR_MINUS_9, .symbols = "-9"},
+/**
+ * Спец. символы: X(code, код этажа, MSB, LSB). Одиночный символ - LSB 'c'.
+ */
+#define UIM6100_SPECIAL_SYMBOLS(X, code)                                       \
+  X(code, RESERVE, 'b', 'c')                                                   \
+  X(code, SEISMIC_DANGER, 'L', 'c')                                            \
+  X(code, LIFT_NOT_WORK, 'A', 'c')                                             \
+  X(code, TRANSFER_FIREFIGHTERS, 'P', 'c')                                     \
+  X(code, CODE_FLOOR_54, 'H', 'c')                                             \
+  X(code, SERVICE, 'C', 'c')                                                   \
+  X(code, EVACUATION, 'E', 'c')                                                \
+  X(code, FIRE_DANGER, 'F', 'c')                                               \
+  X(code, FAULT_IBP, 'U', 'c')                                                 \
+  X(code, LOADING, 'p', 'c')                                                   \
+  X(code, FLOOR_MINUS_1, '-', '1')                                             \
+  X(code, FLOOR_MINUS_2, '-', '2')                                             \
+  X(code, FLOOR_MINUS_3, '-', '3')                                             \
+  X(code, FLOOR_MINUS_4, '-', '4')                                             \
+  X(code, FLOOR_MINUS_5, '-', '5')                                             \
+  X(code, FLOOR_MINUS_6, '-', '6')                                             \
+  X(code, FLOOR_MINUS_7, '-', '7')                                             \
+  X(code, FLOOR_MINUS_8, '-', '8')                                             \
+  X(code, FLOOR_MINUS_9, '-', '9')
+
+#define UIM6100_FLOOR_SYMBOLS(code)                                            \
+  FLOOR_SYMBOLS_ENTRY(code, MAX_POSITIVE_NUMBER_FLOOR, UIM6100_SPECIAL_SYMBOLS)
+
+/// Символы этажа по коду W2 (таблица генерируется при компиляции), если
+/// надписи этажей не загружены по CAN (floor_labels)
+static const floor_symbols_t floor_symbols[FLOOR_CODES_COUNT] =
+    FLOOR_TABLE_64(UIM6100_FLOOR_SYMBOLS);
+
+_Static_assert(CODE_FLOOR_W_2_MASK < FLOOR_CODES_COUNT,
+               "UIM6100 floor code must index floor_symbols");
+_Static_assert(MAIN_CABIN_ID == UIM6100_MAIN_CABIN_CAN_ID,
+               "UIM6100 cabin address must match the menu address scheme");
+
+/**
+ * Строка таблицы звуковых сигналов: сигнал активен, если
+ * (сигналы кадра & mask) == value. Сигналы кадра - 16-битное слово
+ * (W3 << 8) | W1.
+ */
+typedef struct {
+  uint16_t mask;  // Маска битов W3:W1
+  uint16_t value; // Значение битов под маской
+  uint8_t action; // Событие/уровень (uim6100_event_t)
+} uim6100_edge_t;
+
+/// Биты байта W3 в слове сигналов кадра
+#define W3_SIGNAL(bits) ((uint16_t)(bits) << 8)
+
+/// Таблица звуковых сигналов (новый код звука - одна строка)
+static const uim6100_edge_t sound_edges[] = {
+    {W3_SIGNAL(ARRIVAL_MASK), W3_SIGNAL(ARRIVAL_VALUE), UIM6100_EVENT_GONG},
+    {CODE_MESSAGE_W_1_MASK, SOUND_DOORS_OPENING, UIM6100_EVENT_DOOR_OPEN},
+    {CODE_MESSAGE_W_1_MASK, VOICE_DOORS_OPENING, UIM6100_EVENT_DOOR_OPEN},
+    {CODE_MESSAGE_W_1_MASK, SOUND_DOORS_CLOSING, UIM6100_EVENT_DOOR_CLOSE},
+    {CODE_MESSAGE_W_1_MASK, VOICE_DOORS_CLOSING, UIM6100_EVENT_DOOR_CLOSE},
+    {CODE_MESSAGE_W_1_MASK, BUTTON_SOUND_SHORT, UIM6100_EVENT_CALL_BUTTON},
+    {CODE_MESSAGE_W_1_MASK, VOICE_CABIN_OVERLOAD, UIM6100_EVENT_CABIN_OVERLOAD},
+    {CODE_MESSAGE_W_1_MASK, VOICE_FIRE_DANGER, UIM6100_EVENT_FIRE_DANGER},
 };
 
-/// Флаг для контроля состояния кнопки
-static bool is_button_pressed = false;
+#define SOUND_EDGES_COUNT (sizeof(sound_edges) / sizeof(sound_edges[0]))
 
-/// Счетчик для подсчета кол-ва данных о нажатии кнопки приказа (order button is
-/// pressed).
-static uint8_t order_button_cnt = 0;
+_Static_assert(SOUND_EDGES_COUNT <= 16,
+               "uim6100_state_t.active_edges holds up to 16 rows");
 
-/// Счетчик для подсчета пропуска нажатия кнопки (order button is disable sound)
-static uint8_t button_disable_cnt = 0;
+/// Состояние протокола (запись - в прерывании CAN RX).
+static uim6100_state_t uim_state = {{0, 0}, NO_DIRECTION, 0, 0};
 
-/// Флаг для контроля перегруза кабины
-static bool is_cabin_overload = false;
+/// События кадров, еще не обработанные process_data_uim().
+static volatile uint8_t pending_events = UIM6100_EVENT_NONE;
 
-/// Флаг для контроля воспроизведения оповещения при пожарной опасности
-static bool is_fire_danger = false;
+/// Время разбора последнего кадра в мкс (для задержки событий).
+static volatile uint32_t last_frame_us = 0;
 
-extern uint8_t _bip_counter;
+/// Время обработки кадров.
+static volatile uim6100_stats_t uim_stats = {0, 0, 0, 0, 0};
 
-/** Содержит текущее и предыдущее состояние бита прибытия для управления гонгом
- * (фронт сигнала "Прибытие" (бит W[3].2) из 0 в 1).
+/**
+ * @brief  Преобразование значений направления движения UIM6100 в общий тип
+ *         направления, который определен в файле drawing.h.
+ * @param  direction: Значение из enum direction_uim_6100_t:
+ *                    UIM_6100_MOVE_UP/UIM_6100_MOVE_DOWN/UIM_6100_NO_MOVE.
+ * @retval Направление из enum directionType.
  */
-static uint8_t gong[2] = {
-    0,
-};
+static directionType
+transform_direction_to_common(direction_uim_6100_t direction) {
+  switch (direction) {
+  case UIM_6100_MOVE_UP:
+    return DIRECTION_UP;
+  case UIM_6100_MOVE_DOWN:
+    return DIRECTION_DOWN;
+  case UIM_6100_NO_MOVE:
+    return NO_DIRECTION;
+
+  default:
+    return NO_DIRECTION;
+  }
+}
 
 /**
- * @brief  Воспроизведение гонга в зависимости от битов направления в байте W3.
- * @note   1. Записываем бит прибытия, используя маску ARRIVAL_MASK, и
- *            направление, используя маску ARROW_MASK;
- * 		     2. По фронту сигнала "Прибытие" (бит W[3].2) из 0 в 1
- *            воспроизводим гонг play_gong в зависимости от направления.
- *            Проверяем предыдущее (gong[0]) и текущее состояние гонга
- *            (gong[1]).
- * @param  direction_byte_w_3: Байт W3.
- * @param  volume: Уровень громкости (buzzer.h).
- * @retval None
+ * @brief  Обновление состояния по байтам кадра (без побочных эффектов).
+ * @note   За один проход по таблице sound_edges вычисляются уровни сигналов
+ *         (state->levels) и события - фронты относительно предыдущего кадра
+ *         (строки, не совпавшие в state->active_edges).
+ * @param  state: Указатель на состояние протокола (предыдущий кадр).
+ * @param  w1:    Байт W1 (code message).
+ * @param  w2:    Байт W2 (код этажа).
+ * @param  w3:    Байт W3 (направление, прибытие).
+ * @retval События кадра (маска uim6100_event_t).
  */
-static void setting_gong(uint8_t direction_byte_w_3, uint8_t volume) {
-  direction_uim_6100_t direction = direction_byte_w_3 & ARROW_MASK;
-  uint8_t arrival = direction_byte_w_3 & ARRIVAL_MASK;
-
-  // Если сигнал из 0 меняется на 1, тогда детектируем прибытие на этаж
-  gong[0] = (arrival == ARRIVAL_VALUE) != 0 ? 1 : 0;
-
-  if (gong[0] && !gong[1]) {
-
-    switch (direction) {
-    case UIM_6100_MOVE_UP:
-      play_gong(1, GONG_BUZZER_FREQ, volume, BIP_DURATION_GONG);
-      break;
-    case UIM_6100_MOVE_DOWN:
-      play_gong(2, GONG_BUZZER_FREQ, volume, BIP_DURATION_GONG);
-      break;
-    case UIM_6100_NO_MOVE:
-      play_gong(3, GONG_BUZZER_FREQ, volume, BIP_DURATION_GONG);
-      break;
-    default:
-      __NOP();
-      play_gong(3, GONG_BUZZER_FREQ, volume, BIP_DURATION_GONG);
-      break;
+uint8_t uim6100_update(uim6100_state_t *state, uint8_t w1, uint8_t w2,
+                       uint8_t w3) {
+  uint16_t signals = W3_SIGNAL(w3) | w1;
+  uint16_t active_edges = 0;
+  uint8_t levels = UIM6100_EVENT_NONE;
+  uint8_t events = UIM6100_EVENT_NONE;
+
+  for (uint8_t i = 0; i < SOUND_EDGES_COUNT; i++) {
+    if ((signals & sound_edges[i].mask) == sound_edges[i].value) {
+      active_edges |= 1U << i;
+      levels |= sound_edges[i].action;
     }
   }
-  gong[1] = gong[0];
-}
-
-static uint8_t open_sound_edge[2] = {
-    0,
-};
 
-static uint8_t close_sound_edge[2] = {
-    0,
-};
+  // Фронты: строки, совпавшие в текущем кадре и не совпавшие в предыдущем
+  uint16_t rising_edges = active_edges & ~state->active_edges;
+  for (uint8_t i = 0; rising_edges != 0; i++, rising_edges >>= 1) {
+    if (rising_edges & 1U) {
+      events |= sound_edges[i].action;
+    }
+  }
 
-static uint8_t open_voice_edge[2] = {
-    0,
-};
+  state->drawing_data.floor = w2 & CODE_FLOOR_W_2_MASK;
+  state->drawing_data.direction =
+      transform_direction_to_common(w3 & ARROW_MASK);
+  if (events & UIM6100_EVENT_GONG) {
+    state->gong_direction = state->drawing_data.direction;
+  }
+  state->active_edges = active_edges;
+  state->levels = levels;
 
-static uint8_t close_voice_edge[2] = {
-    0,
-};
+  return events;
+}
 
-/// @brief  Флаг контроля - воспроизводится ли звук открытия/закрытия дверей
-/// (для приоритета кнопки вызова)
-bool is_door_sound = false;
 /**
- * @brief Звуки открытия/закрытия дверей
- *
- * @param code_msg_byte_w_1
+ * @brief  Ответ на опрос адреса для кабинного индикатора и 47 адреса.
+ * @param  frame: Указатель на принятый кадр.
+ * @retval None
  */
-static void set_door_sound(uint8_t code_msg_byte_w_1) {
-
-  // Если сигнал из 0 меняется на 1, тогда детектируем прибытие на этаж
-  // sound open
-  open_sound_edge[0] =
-      ((code_msg_byte_w_1 & 0x3F) == SOUND_DOORS_OPENING) ? 1 : 0;
-
-  if (open_sound_edge[0] && !open_sound_edge[1]) {
-
-    play_gong(1, GONG_BUZZER_FREQ, matrix_settings.volume, BIP_DURATION_DOORS);
-    is_door_sound = true;
+static void send_answer_uim(const can_rx_frame_t *frame) {
+  uint32_t std_id = can_frame_std_id(frame);
+  uint32_t answer_id =
+      (uint32_t)matrix_settings.addr_id + UIM6100_ANSWER_ID_OFFSET;
+  uint8_t dlc = can_frame_dlc(frame);
+  uint8_t code_0 = can_frame_byte(frame, BYTE_CODE_OPERATION_0);
+  uint8_t code_1 = can_frame_byte(frame, BYTE_CODE_OPERATION_1);
+
+  // Для КАБИНЫ и 47 адреса
+  if (matrix_settings.addr_id != std_id || std_id < MAIN_CABIN_ID ||
+      std_id == UIM6100_NO_SOUND_ID || code_1 != 0x00) {
+    return;
   }
-  open_sound_edge[1] = open_sound_edge[0];
 
-  // sound close
-  close_sound_edge[0] =
-      ((code_msg_byte_w_1 & 0x3F) == SOUND_DOORS_CLOSING) ? 1 : 0;
+  if (dlc == 2) {
+    if (code_0 == 0x00) {
+      uint8_t buf2[6] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
-  if (close_sound_edge[0] && !close_sound_edge[1]) {
+      can_send_answer(answer_id, 6, buf2);
+    }
 
-    play_gong(2, GONG_BUZZER_FREQ, matrix_settings.volume, BIP_DURATION_DOORS);
-    is_door_sound = true;
-  }
-  close_sound_edge[1] = close_sound_edge[0];
+  } else if (dlc == UIM6100_DLC &&
+             (can_frame_byte(frame, BYTE_W_3) & UIM6100_NO_ANSWER_MASK) == 0) {
+    if (code_0 == UIM6100_CODE_OPERATION_DATA) {
+      uint8_t buf2[2] = {UIM6100_CODE_OPERATION_DATA, 0x00};
 
-  // voice open
-  open_voice_edge[0] =
-      ((code_msg_byte_w_1 & 0x3F) == VOICE_DOORS_OPENING) ? 1 : 0;
+      can_send_answer(answer_id, 2, buf2);
 
-  if (open_voice_edge[0] && !open_voice_edge[1]) {
+    } else if (code_0 == UIM6100_CODE_OPERATION_POLL) {
+      uint8_t buf2[6] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 
-    play_gong(1, GONG_BUZZER_FREQ, matrix_settings.volume, BIP_DURATION_DOORS);
-    is_door_sound = true;
+      can_send_answer(answer_id, 6, buf2);
+    }
   }
-  open_voice_edge[1] = open_voice_edge[0];
+}
 
-  // voice close
-  close_voice_edge[0] =
-      ((code_msg_byte_w_1 & 0x3F) == VOICE_DOORS_CLOSING) ? 1 : 0;
+/**
+ * @brief  Декодер кадров UIM6100 (вызывается из прерывания CAN RX).
+ * @note   1. Ответ на опрос адреса (кабина и 47 адрес);
+ *         2. Разбор кадра с данными прямо из mailbox: обновление состояния
+ *            (uim6100_update()), запись этажа и направления в matrix_string,
+ *            накопление событий для process_data_uim().
+ * @param  frame: Указатель на принятый кадр.
+ * @retval true, если кадр содержит данные UIM6100.
+ */
+bool uim6100_decode_frame(const can_rx_frame_t *frame) {
+  uint32_t start_us = timebase_now_us();
 
-  if (close_voice_edge[0] && !close_voice_edge[1]) {
+  send_answer_uim(frame);
 
-    play_gong(2, GONG_BUZZER_FREQ, matrix_settings.volume, BIP_DURATION_DOORS);
-    is_door_sound = true;
+  if (can_frame_dlc(frame) != UIM6100_DLC ||
+      can_frame_byte(frame, BYTE_CODE_OPERATION_0) !=
+          UIM6100_CODE_OPERATION_DATA ||
+      can_frame_byte(frame, BYTE_CODE_OPERATION_1) != 0x00) {
+    return false;
   }
-  close_voice_edge[1] = close_voice_edge[0];
-}
 
-static uint8_t btn_call_sound_edge[2] = {
-    0,
-};
-/**
- * @brief Звук нажатия кнопки вызова
- *
- * @param code_msg_byte_w_1
- */
-static void set_btn_call_sound(uint8_t code_msg_byte_w_1) {
+  pending_events |= uim6100_update(&uim_state, can_frame_byte(frame, BYTE_W_1),
+                                   can_frame_byte(frame, BYTE_W_2),
+                                   can_frame_byte(frame, BYTE_W_3));
 
-  // Если сигнал из 0 меняется на 1, тогда детектируем прибытие на этаж
-  // sound open
-  btn_call_sound_edge[0] =
-      ((code_msg_byte_w_1 & 0x3F) == BUTTON_SOUND_SHORT) ? 1 : 0;
+  setting_symbols_from_table(matrix_string, &uim_state.drawing_data,
+                             floor_labels_table());
 
-  if (btn_call_sound_edge[0] && !btn_call_sound_edge[1]) {
-    // is_call_btn = true;
+  // Перегруз кабины отображается на кабинном индикаторе
+  if ((uim_state.levels & UIM6100_EVENT_CABIN_OVERLOAD) &&
+      matrix_settings.addr_id == MAIN_CABIN_ID) {
+    matrix_string[DIRECTION] = 'c';
+    matrix_string[MSB] = 'K';
+    matrix_string[LSB] = 'g';
+  }
 
-    /* Если до нажатия кнопки вызова был звук открытия/закрытия дверей, то
-     * останавливаем звук, воспроизводим нажатие кнопки вызова */
-    if (is_door_sound) {
-      stop_buzzer_sound();
-    }
+  last_frame_us = timebase_now_us();
 
-    play_gong(1, GONG_BUZZER_FREQ, matrix_settings.volume,
-              BIP_DURATION_CALL_BTN);
+  uint32_t decode_us = last_frame_us - start_us;
+  uim_stats.frames++;
+  uim_stats.decode_us = decode_us;
+  if (decode_us > uim_stats.max_decode_us) {
+    uim_stats.max_decode_us = decode_us;
   }
-  btn_call_sound_edge[1] = btn_call_sound_edge[0];
+
+  return true;
 }
-#if 0
-static void set_btn_call_sound(uint8_t code_msg_byte_w_1) {
-  /* Нажатие кнопки вызова */
-  if ((code_msg_byte_w_1 & CODE_MESSAGE_W_1_MASK) == BUTTON_SOUND_SHORT) {
-    // if ((code_msg_byte_w_1 & BUTTON_SOUND_SHORT) == BUTTON_SOUND_SHORT) {
-
-    if (button_disable_cnt == 0) {
-      if (matrix_settings.volume != VOLUME_0) {
-        is_button_pressed = true;
-        play_gong(1, 1000, matrix_settings.volume, BIP_DURATION_CALL_BTN);
-      }
-    }
 
-    /** Не воспроизводить последующие нажатия, если кнопка уже нажата;
-     */
-    if (is_button_pressed) {
-      button_disable_cnt++;
-      if (button_disable_cnt == 3) {
-        button_disable_cnt = 0;
-        is_button_pressed = false;
-      }
-    }
+/**
+ * @brief  Звук гонга по направлению в кадре с фронтом прибытия.
+ * @param  gong_direction: Направление движения.
+ * @retval Звук гонга.
+ */
+static sound_id_t gong_sound(directionType gong_direction) {
+  switch (gong_direction) {
+  case DIRECTION_UP:
+    return SOUND_GONG_UP;
+  case DIRECTION_DOWN:
+    return SOUND_GONG_DOWN;
+  default:
+    return SOUND_GONG_NO_MOVE;
   }
 }
-#endif
 
 /**
- * @brief  Обработка code message (байт W1), включение/выключение бузера.
- * @param  code_msg_byte_w_1: Байт W1.
+ * @brief  Включение/выключение непрерывного звука по уровню сигнала.
+ * @param  sound:    Звук.
+ * @param  is_level: Уровень сигнала в последнем кадре.
  * @retval None
  */
-static void process_code_msg(uint8_t code_msg_byte_w_1) {
-
-/* Если гонг отработал и не перегруз/пожар, то воспроизводим нажатие кнопки
- * вызова, иначе не воспроизводим нажатие
- */
-#if 0
-  if (_bip_counter == 0 && !is_cabin_overload && !is_fire_danger) {
-    set_btn_call_sound(code_msg_byte_w_1);
+static void set_alarm_sound(sound_id_t sound, bool is_level) {
+  if (is_level) {
+    sound_request(sound);
+  } else {
+    sound_release(sound);
   }
-#endif
-
-  /* Перегруз кабины: если не Пожар, воспроизводим */
-  if (!is_fire_danger) {
-
-    if ((code_msg_byte_w_1 & CODE_MESSAGE_W_1_MASK) == VOICE_CABIN_OVERLOAD) {
+}
 
-      if (matrix_settings.volume != VOLUME_0) {
-        is_cabin_overload = true;
-        TIM2_Start_bip(BUZZER_FREQ_CABIN_OVERLOAD, VOLUME_3);
-      }
-      matrix_string[DIRECTION] = 'c';
-      matrix_string[MSB] = 'K';
-      matrix_string[LSB] = 'g';
+/**
+ * @brief  Обработка событий протокола UIM6100 (ШК6000): гонг, звуки дверей и
+ *         кнопки вызова, перегруз и пожарная опасность.
+ * @note   Не блокирует: события, накопленные декодером, обрабатываются за один
+ *         вызов. Отображение выполняется в protocol_process_data().
+ * @param  None
+ * @retval None
+ */
+void process_data_uim(void) {
+  __disable_irq();
+  uint8_t events = pending_events;
+  uint16_t floor = uim_state.drawing_data.floor;
+  directionType gong_direction = uim_state.gong_direction;
+  uint8_t levels = uim_state.levels;
+  pending_events = UIM6100_EVENT_NONE;
+  uint32_t frame_us = last_frame_us;
+  __enable_irq();
+
+  uint8_t allowed_events = UIM6100_EVENT_NONE;
 
-    }
-    // Следующие полученные данные по CAN
-    else if (is_cabin_overload) {
-      TIM2_Stop_bip();
-      is_cabin_overload = false;
+  // Кабинный индикатор
+  if (matrix_settings.addr_id == MAIN_CABIN_ID) {
+    /* Проверено на испытаниях */
+    allowed_events = UIM6100_EVENT_GONG;
+    set_alarm_sound(SOUND_CABIN_OVERLOAD,
+                    levels & UIM6100_EVENT_CABIN_OVERLOAD);
+    set_alarm_sound(SOUND_FIRE_DANGER, levels & UIM6100_EVENT_FIRE_DANGER);
+  } else if (matrix_settings.addr_id != UIM6100_NO_SOUND_ID) {
+    // Этажный индикатор: кнопка вызова
+    allowed_events = UIM6100_EVENT_CALL_BUTTON;
+
+    // Гонг, открытие/закрытие дверей
+    if (matrix_settings.addr_id == floor ||
+        matrix_settings.addr_id == UIM6100_GONG_ALWAYS_ID) {
+      allowed_events |= UIM6100_EVENT_GONG | UIM6100_EVENT_DOOR_OPEN |
+                        UIM6100_EVENT_DOOR_CLOSE;
     }
   }
 
-  /* Пожарная опасность */
-  if ((code_msg_byte_w_1 & CODE_MESSAGE_W_1_MASK) == VOICE_FIRE_DANGER) {
-
-    if (matrix_settings.volume != VOLUME_0) {
-      is_fire_danger = true;
-      TIM2_Start_bip(BUZZER_FREQ_FIRE_DANGER, VOLUME_3);
-    }
+  // Приоритет, прерывание и очередь звуков - в арбитре (sound_arbiter.c)
+  events &= allowed_events;
+  if (events & UIM6100_EVENT_CALL_BUTTON) {
+    sound_request(SOUND_CALL_BUTTON);
+  }
+  if (events & UIM6100_EVENT_DOOR_OPEN) {
+    sound_request(SOUND_DOOR_OPEN);
   }
-  // Следующие полученные данные по CAN
-  else if (is_fire_danger) {
-    TIM2_Stop_bip();
-    is_fire_danger = false;
+  if (events & UIM6100_EVENT_DOOR_CLOSE) {
+    sound_request(SOUND_DOOR_CLOSE);
+  }
+  if (events & UIM6100_EVENT_GONG) {
+    sound_request(gong_sound(gong_direction));
+  }
+
+  uint32_t latency_us = timebase_elapsed_us(frame_us);
+  uim_stats.event_latency_us = latency_us;
+  if (latency_us > uim_stats.max_event_latency_us) {
+    uim_stats.max_event_latency_us = latency_us;
   }
 }
 
 /**
- * @brief  Обработка звуковых сигналов: нажатие кнопки приказа, гонг,
- * перегруз, пожарная опасность.
- * @param  code_msg_byte_w_1: Байт W1.
+ * @brief  Сброс состояния протокола.
+ * @note   Таблица символов этажа выбирается по странице LABELS
+ *         (floor_labels_init()).
+ * @param  None
  * @retval None
  */
-static void setting_sound_uim(msg_t *msg) {
-
-  uint8_t code_msg_byte_w_1 = msg->w1;
+void uim6100_reset(void) {
+  __disable_irq();
+  uim_state = (uim6100_state_t){{0, 0}, NO_DIRECTION, 0, 0};
+  pending_events = UIM6100_EVENT_NONE;
+  __enable_irq();
 
-  /* Если гонг отработал и не перегруз/пожар, то воспроизводим нажатие кнопки
-   * вызова, иначе не воспроизводим нажатие
-   */
-  if (_bip_counter == 0 && !is_cabin_overload && !is_fire_danger) {
-    set_btn_call_sound(code_msg_byte_w_1);
-  }
+  floor_labels_init(floor_symbols);
+}
 
-  /* Гонг прибытия */
-  if (!is_fire_danger) {
-    if (matrix_settings.volume != VOLUME_0) {
-      setting_gong(msg->w3, matrix_settings.volume);
-    }
-  }
+/**
+ * @brief  Получение времени обработки кадров.
+ * @param  stats: Указатель на структуру для записи статистики.
+ * @retval None
+ */
+void uim6100_get_stats(uim6100_stats_t *stats) {
+  __disable_irq();
+  *stats = *(uim6100_stats_t *)&uim_stats;
+  __enable_irq();
+}
 
-  /* Перегруз кабины: если не Пожар, воспроизводим */
-  if (!is_fire_danger) {
-    if ((code_msg_byte_w_1 & CODE_MESSAGE_W_1_MASK) == VOICE_CABIN_OVERLOAD) {
+/**
+ * @brief  Отображение "c--" во время автоопределения скорости CAN.
+ * @param  None
+ * @retval None
+ */
+static void draw_autobaud_string(void) { draw_string_on_matrix("c--"); }
 
-      if (matrix_settings.volume != VOLUME_0) {
-        is_cabin_overload = true;
-        TIM2_Start_bip(BUZZER_FREQ_CABIN_OVERLOAD, VOLUME_3);
-      }
+/**
+ * @brief  Инициализация CAN для протокола UIM6100.
+ * @note   Если скорость не сохранена во flash, выполняется автоопределение
+ *         скорости, найденная скорость сохраняется во flash, чтобы при
+ *         следующих запусках сразу использовать её.
+ * @param  None
+ * @retval None
+ */
+static void uim6100_init(void) {
+  if (matrix_settings.can_bitrate >= CAN_BITRATE_COUNT) {
+    matrix_settings.can_bitrate = can_autobaud(draw_autobaud_string);
 
-      matrix_string[DIRECTION] = 'c';
-      matrix_string[MSB] = 'K';
-      matrix_string[LSB] = 'g';
-    }
-    // Следующие полученные данные по CAN
-    else if (is_cabin_overload) {
-      TIM2_Stop_bip();
-      is_cabin_overload = false;
+    if (matrix_settings.can_bitrate != CAN_BITRATE_UNKNOWN) {
+      overwrite_settings(&matrix_settings);
     }
   }
 
-  /* Пожарная опасность */
-  if ((code_msg_byte_w_1 & CODE_MESSAGE_W_1_MASK) == VOICE_FIRE_DANGER) {
-    is_fire_danger = true;
-
-    if (matrix_settings.volume != VOLUME_0) {
-      TIM2_Start_bip(BUZZER_FREQ_FIRE_DANGER, VOLUME_3);
-    }
-
-  }
-  // Следующие полученные данные по CAN
-  else if (is_fire_danger) {
-    TIM2_Stop_bip();
-    is_fire_danger = false;
-  }
+  can_set_bitrate(matrix_settings.can_bitrate);
+  MX_CAN_Init();
 }
 
-/// Структура с данными для отображения (direction, floor).
-static drawing_data_t drawing_data = {0, 0};
-
 /**
- * @brief  Преобразование значений направления движения UIM6100 в общий тип
- *         направления, который определен в файле drawing.h.
- * @param  direction: Значение из enum direction_uim_6100_t:
- *                    UIM_6100_MOVE_UP/UIM_6100_MOVE_DOWN/UIM_6100_NO_MOVE.
+ * @brief  Запуск протокола UIM6100: сброс состояния, звуков и монитора связи,
+ *         запуск CAN с фильтром по адресу индикатора.
+ * @param  None
  * @retval None
  */
-static void transform_direction_to_common(direction_uim_6100_t direction) {
-  switch (direction) {
-  case UIM_6100_MOVE_UP:
-    drawing_data.direction = DIRECTION_UP;
-    break;
-  case UIM_6100_MOVE_DOWN:
-    drawing_data.direction = DIRECTION_DOWN;
-    break;
-  case UIM_6100_NO_MOVE:
-    drawing_data.direction = NO_DIRECTION;
-    break;
+static void uim6100_start(void) {
+  link_health_reset(TIME_MS_FOR_INTERFACE_CONNECTION);
+  uim6100_reset();
+  sound_reset(matrix_settings.volume);
+  can_set_frame_decoder(uim6100_decode_frame);
 
-  default:
-    drawing_data.direction = NO_DIRECTION;
-    break;
+  bool is_id_from_flash_valid = matrix_settings.addr_id >= ADDR_ID_MIN &&
+                                matrix_settings.addr_id <= ADDR_ID_LIMIT;
+
+  if (is_id_from_flash_valid) {
+    start_can(&hcan, matrix_settings.addr_id);
+  } else {
+    start_can(&hcan, MAIN_CABIN_ID);
   }
 }
 
 /**
- * @brief  Обработка данных по протоколу UIM6100 (ШК6000).
- * @note   1. Установка структуры drawing_data, обработка code message,
- *            воспроизведение гонга и отображение символов;
- *         2. Отображение matrix_string пока следующие данные не получены и
- *            интерфейс CAN подключен.
- * @param  msg: Указатель на структуру полученных данных.
- * @retval None
+ * @brief  Проход задачи протокола UIM6100 (не блокирует).
+ * @note   1. Связь: повторное автоопределение скорости CAN при долгом
+ *            отсутствии кадров, восстановление CAN после bus-off;
+ *         2. Команды надписей этажей от ПК;
+ *         3. События принятых кадров, если интерфейс подключен.
+ *         Звуки обрабатывает задача звука (sound_process()).
+ * @param  None
+ * @retval true, если идет восстановление CAN (не дольше
+ *         CAN_RECOVERY_HOLD_FLOOR_MS) и отображается последний этаж.
  */
+static bool uim6100_process(void) {
+  can_relearn_process();
+  bool is_link_recovering = can_recovery_process();
+  can_label_command_process();
 
-bool is_call_btn = false;
-void process_data_uim(msg_t *msg) {
-  /// Флаг для контроля полученных данных по CAN.
-  extern volatile bool is_data_received;
-
-  uint8_t code_msg = msg->w1;
-  drawing_data.floor = msg->w2 & CODE_FLOOR_W_2_MASK;
-
-  transform_direction_to_common(msg->w3 & ARROW_MASK);
-
-  setting_symbols(matrix_string, &drawing_data, MAX_POSITIVE_NUMBER_FLOOR,
-                  special_symbols_code_location, SPECIAL_SYMBOLS_BUFF_SIZE);
-
-  // Кабинный индикатор
-  if (matrix_settings.addr_id == MAIN_CABIN_ID) {
-#if 1
-    /* Проверено на испытаниях */
-    if (matrix_settings.volume != VOLUME_0) {
-      setting_gong(msg->w3, matrix_settings.volume);
-    }
-    process_code_msg(code_msg);
-#else
-    /* Функция для обработки ВСЕХ звукрвых оповещений */
-    setting_sound_uim(msg);
-#endif
-  } else {
-    // Этажный индикатор
-    if (matrix_settings.addr_id != 49) { // Обработка звуков
-      /* Если гонг отработал, то воспроизводим
-       * нажатие кнопки вызова, иначе не воспроизводим нажатие.
-       * Если звук открытия/закрытия дверей, то воспроизводим
-       * нажатие кнопки вызова
-       */
-      if (_bip_counter == 0 || is_door_sound) {
-        if (matrix_settings.volume != VOLUME_0) {
-          set_btn_call_sound(msg->w1);
-        }
-      }
-
-      // Гонг, открытие/закрытие дверей
-      if (matrix_settings.addr_id == drawing_data.floor ||
-          matrix_settings.addr_id == 47) {
-        if (matrix_settings.volume != VOLUME_0) {
-
-          if (_bip_counter == 0) {
-            set_door_sound(msg->w1);
-          }
-
-          setting_gong(msg->w3, matrix_settings.volume);
-        }
-      }
-    } // if (matrix_settings.addr_id != 49)
+  if (is_interface_connected && can_take_received_data()) {
+    process_data_uim();
   }
+  return is_link_recovering;
+}
 
-  /*
-   * Пока новые 6 байт данных не получены и CAN подключен, отображаем текущую
-   * matrix_string
-   */
-  while (is_data_received == false && is_interface_connected == true) {
-    draw_string_on_matrix(matrix_string);
-  }
+/**
+ * @brief  Остановка протокола UIM6100 (вход в меню).
+ * @param  None
+ * @retval None
+ */
+static void uim6100_stop(void) {
+  stop_can(&hcan);
+  sound_reset(VOLUME_0);
 }
+
+/// Описание протокола для реестра (protocol_selection.c)
+const protocol_t uim6100_protocol = {
+    .id = PROTOCOL_ID_UIM_6100,
+    .name = "SHK",
+    .init = uim6100_init,
+    .start = uim6100_start,
+    .process = uim6100_process,
+    .stop = uim6100_stop,
+};
@@ -5,30 +5,100 @@
 #ifndef UIM6100_H
 #define UIM6100_H
 
+#include "can.h"
+#include "drawing.h"
+#include "protocol_selection.h"
+
+#include <stdbool.h>
 #include <stdint.h>
 
 #define UIM6100_DLC 6 ///< Длина сообщения (6 байт)
 #define UIM6100_MAIN_CABIN_CAN_ID 46 ///< ID кабинного индикатора
 
-/*
- * Структура для сохранения полученных байтов по CAN.
+/**
+ * Звуковые сигналы UIM6100 (битовая маска): фронт сигнала - событие, текущее
+ * значение - уровень.
+ */
+typedef enum {
+  UIM6100_EVENT_NONE = 0,
+  UIM6100_EVENT_GONG = 1 << 0,           // Прибытие (бит W[3].2)
+  UIM6100_EVENT_DOOR_OPEN = 1 << 1,      // Открытие дверей (звук или голос)
+  UIM6100_EVENT_DOOR_CLOSE = 1 << 2,     // Закрытие дверей (звук или голос)
+  UIM6100_EVENT_CALL_BUTTON = 1 << 3,    // Нажатие кнопки вызова
+  UIM6100_EVENT_CABIN_OVERLOAD = 1 << 4, // Перегруз кабины
+  UIM6100_EVENT_FIRE_DANGER = 1 << 5     // Пожарная опасность
+} uim6100_event_t;
+
+/**
+ * Состояние протокола UIM6100 после последнего кадра.
  */
 typedef struct {
-  uint8_t w0;
-  uint8_t w1;
-  uint8_t w2;
-  uint8_t w3;
-} msg_t;
-
-/**
- * @brief  Обработка данных по протоколу UIM6100 (ШК6000).
- * @note   1. Установка структуры drawing_data, обработка code message,
- *            воспроизведение гонга и отображение символов;
- *         2. Отображение matrix_string пока следующие данные не получены и
- *            интерфейс CAN подключен.
- * @param  msg: Указатель на структуру полученных данных.
+  drawing_data_t drawing_data;  // Данные для отображения (direction, floor)
+  directionType gong_direction; // Направление в кадре с фронтом прибытия
+  uint16_t active_edges;        // Строки таблицы сигналов, совпавшие в кадре
+  uint8_t levels;               // Уровни сигналов (маска uim6100_event_t)
+} uim6100_state_t;
+
+/**
+ * Время обработки кадров UIM6100 в мкс (шкала времени timebase.h).
+ */
+typedef struct {
+  uint32_t frames;               // Кол-во кадров с данными
+  uint32_t decode_us;            // Разбор последнего кадра
+  uint32_t max_decode_us;        // Максимальное время разбора
+  uint32_t event_latency_us;     // От кадра до обработки его событий
+  uint32_t max_event_latency_us; // Максимальная задержка событий
+} uim6100_stats_t;
+
+/// Описание протокола для реестра протоколов (protocol_selection.c)
+extern const protocol_t uim6100_protocol;
+
+/**
+ * @brief  Обновление состояния по байтам кадра (без побочных эффектов).
+ * @param  state: Указатель на состояние протокола (предыдущий кадр).
+ * @param  w1:    Байт W1 (code message).
+ * @param  w2:    Байт W2 (код этажа).
+ * @param  w3:    Байт W3 (направление, прибытие).
+ * @retval События кадра (маска uim6100_event_t).
+ */
+uint8_t uim6100_update(uim6100_state_t *state, uint8_t w1, uint8_t w2,
+                       uint8_t w3);
+
+/**
+ * @brief  Декодер кадров UIM6100 (вызывается из прерывания CAN RX).
+ * @note   1. Ответ на опрос адреса (кабина и 47 адрес);
+ *         2. Разбор кадра с данными прямо из mailbox: обновление состояния
+ *            (uim6100_update()), запись этажа и направления в matrix_string,
+ *            накопление событий для process_data_uim().
+ * @param  frame: Указатель на принятый кадр.
+ * @retval true, если кадр содержит данные UIM6100.
+ */
+bool uim6100_decode_frame(const can_rx_frame_t *frame);
+
+/**
+ * @brief  Обработка событий протокола UIM6100 (ШК6000): гонг, звуки дверей и
+ *         кнопки вызова, перегруз и пожарная опасность.
+ * @note   Не блокирует: события, накопленные декодером, обрабатываются за один
+ *         вызов. Отображение выполняется в protocol_process_data().
+ * @param  None
+ * @retval None
+ */
+void process_data_uim(void);
+
+/**
+ * @brief  Сброс состояния протокола.
+ * @note   Таблица символов этажа выбирается по странице LABELS
+ *         (floor_labels_init()).
+ * @param  None
+ * @retval None
+ */
+void uim6100_reset(void);
+
+/**
+ * @brief  Получение времени обработки кадров.
+ * @param  stats: Указатель на структуру для записи статистики.
  * @retval None
  */
-void process_data_uim(msg_t *msg);
+void uim6100_get_stats(uim6100_stats_t *stats);
 
 #endif // UIM6100_H
@@ -0,0 +1,15 @@
+/**
+ * @file    main.h
+ * @brief   Заглушка main.h для проверки startup.c на ПК: время HAL_GetTick()
+ *          и Error_Handler() задает тест (test_startup.c).
+ */
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include <stdint.h>
+
+uint32_t HAL_GetTick(void);
+
+void Error_Handler(void);
+
+#endif /* __MAIN_H */
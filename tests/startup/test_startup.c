@@ -0,0 +1,171 @@
+/**
+ * @file    test_startup.c
+ * @brief   Проверка порядка шагов запуска (startup_run()) на ПК.
+ * @note    1. Шаги выполняются один раз, каждый - после своих зависимостей,
+ *             из готовых шагов - шаг с меньшим индексом;
+ *          2. Время шагов - по шкале времени (timebase_now_us()) и
+ *             сохраняется в startup_stats_t.step_us;
+ *          3. Цикл зависимостей - Error_Handler(), шаги цикла не
+ *             выполняются.
+ */
+#include "display_sync.h"
+#include "main.h"
+#include "startup.h"
+#include "timebase.h"
+#include "timer_wheel.h"
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// Время одного шага в мкс (шкала времени заглушки идет только в шагах).
+#define STEP_US 100
+
+/// Шкала времени заглушки в мкс.
+static uint32_t now_us = 0;
+
+/// Порядок выполненных шагов.
+static startup_step_id_t order[STARTUP_STEPS_COUNT * 2];
+
+/// Кол-во выполненных шагов.
+static uint8_t order_count = 0;
+
+/// Возврат из Error_Handler() (цикл зависимостей).
+static jmp_buf error_jump;
+
+/// Кол-во ошибок проверки.
+static int failures = 0;
+
+uint32_t HAL_GetTick(void) { return now_us / 1000; }
+
+void Error_Handler(void) { longjmp(error_jump, 1); }
+
+uint32_t timebase_now_us(void) { return now_us; }
+
+uint32_t timebase_elapsed_us(uint32_t start_us) { return now_us - start_us; }
+
+void timer_wheel_start_once(timer_wheel_timer_t *timer, uint32_t delay_ms,
+                            timer_wheel_callback_t callback) {
+  timer->expires_ms = delay_ms;
+  timer->callback = callback;
+}
+
+void timer_wheel_stop(timer_wheel_timer_t *timer) { timer->callback = NULL; }
+
+void display_sync_get_stats(display_sync_stats_t *stats) {
+  *stats = (display_sync_stats_t){0};
+}
+
+/**
+ * @brief  Фиксация выполненного шага.
+ * @param  id: Шаг.
+ * @retval None
+ */
+static void record_step(startup_step_id_t id) {
+  if (order_count < sizeof(order) / sizeof(order[0])) {
+    order[order_count] = id;
+  }
+  order_count++;
+  now_us += STEP_US * (id + 1);
+}
+
+static void step_0(void) { record_step(0); }
+static void step_1(void) { record_step(1); }
+static void step_2(void) { record_step(2); }
+static void step_3(void) { record_step(3); }
+static void step_4(void) { record_step(4); }
+
+/// Функции шагов (индекс - шаг).
+static void (*const step_runs[STARTUP_STEPS_COUNT])(void) = {
+    step_0, step_1, step_2, step_3, step_4};
+
+/**
+ * @brief  Проверка условия с выводом ошибки.
+ * @param  condition: Условие.
+ * @param  test:      Имя проверки.
+ * @param  message:   Описание условия.
+ * @retval None
+ */
+static void check(bool condition, const char *test, const char *message) {
+  if (!condition) {
+    printf("%s: %s\n", test, message);
+    failures++;
+  }
+}
+
+/**
+ * @brief  Выполнение таблицы шагов.
+ * @param  deps: Зависимости шагов (маски STARTUP_DEP()).
+ * @retval true, если вызван Error_Handler().
+ */
+static bool run_table(const uint32_t *deps) {
+  startup_step_t steps[STARTUP_STEPS_COUNT];
+  for (uint8_t id = 0; id < STARTUP_STEPS_COUNT; id++) {
+    steps[id] = (startup_step_t){"step", step_runs[id], deps[id]};
+  }
+
+  order_count = 0;
+  if (setjmp(error_jump) != 0) {
+    return true;
+  }
+  startup_run(steps);
+  return false;
+}
+
+/**
+ * @brief  Проверка порядка: шаги по одному разу, после зависимостей.
+ * @param  test:     Имя проверки.
+ * @param  deps:     Зависимости шагов.
+ * @param  expected: Ожидаемый порядок шагов.
+ * @retval None
+ */
+static void test_order(const char *test, const uint32_t *deps,
+                       const startup_step_id_t *expected) {
+  bool is_error = run_table(deps);
+
+  check(!is_error, test, "Error_Handler() without dependency cycle");
+  check(order_count == STARTUP_STEPS_COUNT, test, "each step runs once");
+
+  for (uint8_t i = 0; i < STARTUP_STEPS_COUNT && i < order_count; i++) {
+    check(order[i] == expected[i], test, "step order");
+  }
+
+  startup_stats_t stats;
+  startup_get_stats(&stats);
+  for (uint8_t id = 0; id < STARTUP_STEPS_COUNT; id++) {
+    check(stats.step_us[id] == STEP_US * (id + 1u), test, "step time");
+  }
+}
+
+int main(void) {
+  // Таблица main.c: настройки -> протокол -> заставка, интерфейс -> прием
+  static const uint32_t app_deps[STARTUP_STEPS_COUNT] = {
+      [STARTUP_SETTINGS] = 0,
+      [STARTUP_PROTOCOL] = STARTUP_DEP(STARTUP_SETTINGS),
+      [STARTUP_SPLASH] = STARTUP_DEP(STARTUP_PROTOCOL),
+      [STARTUP_INTERFACE] = STARTUP_DEP(STARTUP_PROTOCOL),
+      [STARTUP_RECEPTION] = STARTUP_DEP(STARTUP_INTERFACE),
+  };
+  static const startup_step_id_t app_order[STARTUP_STEPS_COUNT] = {
+      STARTUP_SETTINGS, STARTUP_PROTOCOL, STARTUP_SPLASH, STARTUP_INTERFACE,
+      STARTUP_RECEPTION};
+  test_order("app table", app_deps, app_order);
+
+  // Зависимости против индекса: 0 <- 4 <- 3, 1 <- 2
+  static const uint32_t reverse_deps[STARTUP_STEPS_COUNT] = {
+      STARTUP_DEP(4), STARTUP_DEP(2), 0, 0, STARTUP_DEP(3)};
+  static const startup_step_id_t reverse_order[STARTUP_STEPS_COUNT] = {
+      2, 1, 3, 4, 0};
+  test_order("reverse deps", reverse_deps, reverse_order);
+
+  // Цикл 3 <-> 4: шаги 0..2 выполняются, затем Error_Handler()
+  static const uint32_t cycle_deps[STARTUP_STEPS_COUNT] = {
+      0, 0, 0, STARTUP_DEP(4), STARTUP_DEP(3)};
+  bool is_error = run_table(cycle_deps);
+  check(is_error, "cycle", "Error_Handler() on dependency cycle");
+  check(order_count == 3, "cycle", "steps of the cycle do not run");
+
+  printf("%s\n", failures == 0 ? "startup: OK" : "startup: FAILED");
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
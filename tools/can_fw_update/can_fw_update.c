@@ -0,0 +1,760 @@
+/**
+ * @file    can_fw_update.c
+ * @brief   Программа на ПК (Linux, SocketCAN) для обновления ПО индикаторов
+ *          по CAN. Образ передается одновременно всем индикаторам
+ *          широковещательными кадрами (см. fw_update_protocol.h).
+ * @note    Использование: can_fw_update <интерфейс> <образ.bin> [адрес]
+ *          Без адреса обновляются все индикаторы, ответившие на FW_CMD_START.
+ *          Надписи этажей: can_fw_update <интерфейс> --labels <код=XY,...>
+ *          [адрес], стирание надписей: --labels-clear вместо --labels.
+ *          Статистика индикатора: can_fw_update <интерфейс> --diag <адрес>.
+ *          Причина перезапуска: can_fw_update <интерфейс> --reset-cause
+ *          [адрес].
+ */
+#include "fw_update_protocol.h"
+
+#include <errno.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_NODES 64                 ///< Максимальное кол-во индикаторов
+#define MAX_IMAGE_SIZE (54 * 1024)   ///< Размер области APP/DOWNLOAD
+#define ENTER_DELAY_MS 500           ///< Время перезапуска в загрузчик
+#define DISCOVERY_MS 5000            ///< Время ожидания ответов на START
+#define START_RETRY_MS 500           ///< Период повтора FW_CMD_START
+#define ACK_TIMEOUT_MS 300           ///< Время ожидания подтверждения окна
+#define MAX_RETRIES 10               ///< Кол-во повторов до отключения узла
+#define COMMIT_TIMEOUT_MS 1000       ///< Время ожидания ответа на COMMIT
+#define COMMIT_RETRIES 3             ///< Кол-во повторов FW_CMD_COMMIT
+#define TX_RETRY_US 200              ///< Пауза при заполненной очереди CAN
+#define LABEL_TIMEOUT_MS 300         ///< Время ожидания ответа на LABEL_SET
+#define LABEL_COMMIT_TIMEOUT_MS 1000 ///< Время записи страницы надписей
+#define DIAG_TIMEOUT_MS 100          ///< Время ожидания FW_CMD_DIAG_INFO
+#define RESET_INFO_TIMEOUT_MS 300    ///< Время ожидания FW_CMD_RESET_INFO
+
+/**
+ * Состояние обновления одного индикатора.
+ */
+typedef struct {
+  uint8_t addr;       // Адрес индикатора
+  bool is_active;     // Индикатор участвует в передаче
+  bool has_status;    // Получен ответ FW_CMD_STATUS на последнюю команду
+  uint8_t state;      // fw_state_t из последнего ответа
+  uint8_t result;     // fw_result_t из последнего ответа
+  uint32_t acked;     // Подтвержденное смещение образа
+  uint8_t retries;    // Кол-во повторов без продвижения
+  bool has_diag;      // Получен ответ FW_CMD_DIAG_INFO
+  uint8_t diag_rec;   // fw_diag_record_t из ответа
+  uint8_t diag_sel;   // Элемент и поле из ответа
+  uint32_t diag;      // Значение поля статистики из ответа
+  bool has_reset;     // Получен ответ FW_CMD_RESET_INFO
+  uint8_t reset;      // fw_reset_cause_t из ответа
+  uint8_t hung_mask;  // Задачи, не отметившиеся перед сбросом IWDG
+  uint16_t wd_resets; // Кол-во сбросов IWDG после включения питания
+} node_t;
+
+/// Сокет CAN.
+static int can_socket = -1;
+
+/// Индикаторы, участвующие в обновлении.
+static node_t nodes[MAX_NODES];
+
+/// Кол-во индикаторов в nodes.
+static int node_count = 0;
+
+/// Флаг приема новых индикаторов (только во время FW_CMD_START).
+static bool is_discovery = false;
+
+/// Смещение следующего отправляемого блока.
+static uint32_t send_offset = 0;
+
+/// Максимальный STmin (мс) из FC индикаторов.
+static uint8_t st_min_ms = 0;
+
+/**
+ * @brief  Текущее время в мс (монотонное).
+ * @param  None
+ * @retval Время в мс.
+ */
+static uint64_t now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief  Открытие сокета CAN с фильтром ответов индикаторов.
+ * @param  ifname: Имя интерфейса (например, can0).
+ * @retval true, если сокет открыт.
+ */
+static bool open_can(const char *ifname) {
+  struct sockaddr_can addr = {0};
+  struct ifreq ifr = {0};
+  struct can_filter filter = {
+      .can_id = FW_UPDATE_NODE_ID_BASE,
+      .can_mask = CAN_SFF_MASK & ~(uint32_t)0x3F,
+  };
+
+  can_socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+  if (can_socket < 0) {
+    perror("socket");
+    return false;
+  }
+
+  snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifname);
+  if (ioctl(can_socket, SIOCGIFINDEX, &ifr) < 0) {
+    perror(ifname);
+    return false;
+  }
+
+  setsockopt(can_socket, SOL_CAN_RAW, CAN_RAW_FILTER, &filter,
+             sizeof(filter));
+
+  addr.can_family = AF_CAN;
+  addr.can_ifindex = ifr.ifr_ifindex;
+  if (bind(can_socket, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    perror("bind");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief  Отправка кадра всем индикаторам (FW_UPDATE_HOST_ID).
+ * @note   При заполненной очереди интерфейса отправка повторяется.
+ * @param  data: Указатель на данные кадра.
+ * @param  len:  Длина данных (DLC).
+ * @retval None
+ */
+static void send_frame(const uint8_t *data, uint8_t len) {
+  struct can_frame frame = {0};
+
+  frame.can_id = FW_UPDATE_HOST_ID;
+  frame.can_dlc = len;
+  memcpy(frame.data, data, len);
+
+  while (write(can_socket, &frame, sizeof(frame)) != sizeof(frame)) {
+    if (errno != ENOBUFS && errno != EAGAIN) {
+      perror("write");
+      exit(EXIT_FAILURE);
+    }
+    usleep(TX_RETRY_US);
+  }
+}
+
+/**
+ * @brief  Отправка команды (SF).
+ * @param  cmd:     Команда fw_cmd_t.
+ * @param  target:  Адрес индикатора или FW_UPDATE_BROADCAST_ADDR.
+ * @param  arg:     Аргумент команды (LE32) или NULL.
+ * @retval None
+ */
+static void send_command(uint8_t cmd, uint8_t target, const uint32_t *arg) {
+  uint8_t data[8] = {ISOTP_PCI_SF | 2, cmd, target};
+  uint8_t len = 3;
+
+  if (arg != NULL) {
+    data[0] = ISOTP_PCI_SF | 6;
+    fw_update_put_le32(&data[3], *arg);
+    len = 7;
+  }
+  send_frame(data, len);
+}
+
+/**
+ * @brief  Отправка блока образа (FF + CF).
+ * @param  image:  Указатель на образ.
+ * @param  size:   Размер образа.
+ * @param  offset: Смещение блока.
+ * @retval Кол-во отправленных байт образа.
+ */
+static uint32_t send_block(const uint8_t *image, uint32_t size,
+                           uint32_t offset) {
+  uint32_t len = size - offset;
+  if (len > FW_UPDATE_BLOCK_SIZE) {
+    len = FW_UPDATE_BLOCK_SIZE;
+  }
+
+  uint32_t msg_len = len + FW_UPDATE_BLOCK_HEADER_SIZE;
+  uint8_t data[8] = {ISOTP_PCI_FF | (uint8_t)(msg_len >> 8), (uint8_t)msg_len};
+  fw_update_put_le32(&data[2], offset);
+
+  uint32_t pos = ISOTP_FF_DATA_SIZE - FW_UPDATE_BLOCK_HEADER_SIZE;
+  memcpy(&data[6], &image[offset], pos < len ? pos : len);
+  send_frame(data, sizeof(data));
+
+  for (uint8_t sn = 1; pos < len; sn = (sn + 1) & ISOTP_SN_MASK) {
+    uint32_t chunk = len - pos;
+    if (chunk > ISOTP_CF_DATA_SIZE) {
+      chunk = ISOTP_CF_DATA_SIZE;
+    }
+
+    data[0] = ISOTP_PCI_CF | sn;
+    memcpy(&data[1], &image[offset + pos], chunk);
+    send_frame(data, (uint8_t)(chunk + 1));
+    pos += chunk;
+
+    if (st_min_ms != 0) {
+      usleep(st_min_ms * 1000U);
+    }
+  }
+  return len;
+}
+
+/**
+ * @brief  Поиск индикатора по адресу.
+ * @param  addr: Адрес индикатора.
+ * @retval Указатель на индикатор или NULL (новый добавляется только во время
+ *         FW_CMD_START).
+ */
+static node_t *find_node(uint8_t addr) {
+  for (int i = 0; i < node_count; i++) {
+    if (nodes[i].addr == addr) {
+      return &nodes[i];
+    }
+  }
+
+  if (!is_discovery || node_count >= MAX_NODES) {
+    return NULL;
+  }
+
+  node_t *node = &nodes[node_count++];
+  memset(node, 0, sizeof(*node));
+  node->addr = addr;
+  return node;
+}
+
+/**
+ * @brief  Прием и обработка ответа индикатора.
+ * @param  timeout_ms: Время ожидания кадра в мс.
+ * @retval true, если кадр принят.
+ */
+static bool receive_answer(int timeout_ms) {
+  struct pollfd pfd = {.fd = can_socket, .events = POLLIN};
+  struct can_frame frame;
+
+  if (poll(&pfd, 1, timeout_ms) <= 0 ||
+      read(can_socket, &frame, sizeof(frame)) != sizeof(frame)) {
+    return false;
+  }
+
+  node_t *node = find_node((uint8_t)(frame.can_id - FW_UPDATE_NODE_ID_BASE));
+  if (node == NULL || frame.can_dlc == 0) {
+    return true;
+  }
+
+  uint8_t pci = frame.data[0] & ISOTP_PCI_MASK;
+
+  if (pci == ISOTP_PCI_SF && frame.can_dlc >= 4 &&
+      frame.data[1] == FW_CMD_STATUS) {
+    node->state = frame.data[2];
+    node->result = frame.data[3];
+    node->has_status = true;
+
+  } else if (pci == ISOTP_PCI_SF && frame.can_dlc >= 8 &&
+             frame.data[1] == FW_CMD_DIAG_INFO) {
+    node->diag_rec = frame.data[2];
+    node->diag_sel = frame.data[3];
+    node->diag = fw_update_get_le32(&frame.data[4]);
+    node->has_diag = true;
+  } else if (pci == ISOTP_PCI_SF && frame.can_dlc >= 6 &&
+             frame.data[1] == FW_CMD_RESET_INFO) {
+    node->reset = frame.data[2];
+    node->hung_mask = frame.data[3];
+    node->wd_resets = (uint16_t)(frame.data[4] | (frame.data[5] << 8));
+    node->has_reset = true;
+
+  } else if (pci == ISOTP_PCI_FC && frame.can_dlc >= 7 && node->is_active) {
+    uint8_t flow_status = frame.data[0] & ~ISOTP_PCI_MASK;
+    uint32_t offset = fw_update_get_le32(&frame.data[3]);
+
+    if (frame.data[2] > st_min_ms && frame.data[2] <= 127) {
+      st_min_ms = frame.data[2];
+    }
+
+    if (flow_status == ISOTP_FS_OVFLW) {
+      node->is_active = false;
+      printf("node %u: flash write error at %u\n", node->addr, offset);
+      return true;
+    }
+
+    if (offset > node->acked) {
+      node->retries = 0;
+    }
+    node->acked = offset;
+
+    // Go-back-N: повтор со смещения индикатора, пропустившего данные
+    if (flow_status == ISOTP_FS_RETRY && offset < send_offset) {
+      send_offset = offset;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief  Подготовка индикаторов: FW_CMD_START до ответа READY.
+ * @param  target: Адрес индикатора или FW_UPDATE_BROADCAST_ADDR.
+ * @param  size:   Размер образа.
+ * @retval Кол-во индикаторов, готовых к приему.
+ */
+static int start_nodes(uint8_t target, uint32_t size) {
+  uint64_t start = now_ms();
+  uint64_t last_start = 0;
+  int ready = 0;
+
+  is_discovery = true;
+  while (now_ms() - start < DISCOVERY_MS) {
+    if (now_ms() - last_start >= START_RETRY_MS) {
+      send_command(FW_CMD_START, target, &size);
+      last_start = now_ms();
+    }
+
+    receive_answer(10);
+
+    ready = 0;
+    for (int i = 0; i < node_count; i++) {
+      nodes[i].is_active = nodes[i].has_status &&
+                           nodes[i].result == FW_RESULT_OK &&
+                           (nodes[i].state == FW_STATE_READY ||
+                            nodes[i].state == FW_STATE_RECEIVING);
+      ready += nodes[i].is_active ? 1 : 0;
+    }
+
+    if (target != FW_UPDATE_BROADCAST_ADDR && ready == 1) {
+      break;
+    }
+  }
+  is_discovery = false;
+
+  return ready;
+}
+
+/**
+ * @brief  Передача образа с окном FW_UPDATE_WINDOW_BLOCKS блоков.
+ * @note   Окно отсчитывается от наименьшего подтвержденного смещения среди
+ *         индикаторов. Индикатор без продвижения MAX_RETRIES раз отключается.
+ * @param  image: Указатель на образ.
+ * @param  size:  Размер образа.
+ * @retval None
+ */
+static void stream_image(const uint8_t *image, uint32_t size) {
+  const uint32_t window = FW_UPDATE_WINDOW_BLOCKS * FW_UPDATE_BLOCK_SIZE;
+  send_offset = 0;
+
+  for (;;) {
+    uint32_t base = size;
+    for (int i = 0; i < node_count; i++) {
+      if (nodes[i].is_active && nodes[i].acked < base) {
+        base = nodes[i].acked;
+      }
+    }
+
+    if (base >= size) {
+      return; // Все активные индикаторы приняли образ (или активных нет)
+    }
+
+    if (send_offset < base) {
+      send_offset = base;
+    }
+
+    if (send_offset < size && send_offset < base + window) {
+      send_offset += send_block(image, size, send_offset);
+      while (receive_answer(0)) {
+      }
+      continue;
+    }
+
+    if (receive_answer(ACK_TIMEOUT_MS)) {
+      continue;
+    }
+
+    // Нет подтверждений: повтор с base, отстающие индикаторы отключаются
+    for (int i = 0; i < node_count; i++) {
+      if (nodes[i].is_active && nodes[i].acked == base &&
+          ++nodes[i].retries > MAX_RETRIES) {
+        nodes[i].is_active = false;
+        printf("node %u: no progress at %u\n", nodes[i].addr, base);
+      }
+    }
+    send_offset = base;
+
+    printf("\r%u / %u", base, size);
+    fflush(stdout);
+  }
+}
+
+/**
+ * @brief  Проверка CRC и установка образа (FW_CMD_COMMIT).
+ * @param  target: Адрес индикатора или FW_UPDATE_BROADCAST_ADDR.
+ * @param  crc:    CRC-32 образа.
+ * @retval None
+ */
+static void commit_nodes(uint8_t target, uint32_t crc) {
+  for (int i = 0; i < node_count; i++) {
+    nodes[i].has_status = false;
+  }
+
+  for (int attempt = 0; attempt < COMMIT_RETRIES; attempt++) {
+    send_command(FW_CMD_COMMIT, target, &crc);
+
+    uint64_t start = now_ms();
+    bool is_waiting = true;
+    while (is_waiting && now_ms() - start < COMMIT_TIMEOUT_MS) {
+      receive_answer(10);
+
+      is_waiting = false;
+      for (int i = 0; i < node_count; i++) {
+        is_waiting |= nodes[i].is_active && !nodes[i].has_status;
+      }
+    }
+
+    if (!is_waiting) {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief  Чтение образа из файла.
+ * @param  path:  Путь к файлу .bin.
+ * @param  image: Буфер размером MAX_IMAGE_SIZE.
+ * @retval Размер образа, 0 - ошибка.
+ */
+static uint32_t read_image(const char *path, uint8_t *image) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    perror(path);
+    return 0;
+  }
+
+  size_t size = fread(image, 1, MAX_IMAGE_SIZE, file);
+  bool is_too_large = fgetc(file) != EOF;
+  fclose(file);
+
+  if (is_too_large) {
+    fprintf(stderr, "%s: image larger than %u bytes\n", path, MAX_IMAGE_SIZE);
+    return 0;
+  }
+  return (uint32_t)size;
+}
+
+/**
+ * @brief  Отправка команды надписей этажей и сбор ответов FW_CMD_STATUS.
+ * @note   Индикаторы, ответившие на первую команду, ожидаются и в следующих.
+ * @param  data:       Данные SF (команда FW_CMD_LABEL_*).
+ * @param  len:        Длина данных (DLC).
+ * @param  target:     Адрес индикатора или FW_UPDATE_BROADCAST_ADDR.
+ * @param  timeout_ms: Время ожидания ответов в мс.
+ * @retval Кол-во индикаторов без ответа или с ошибкой.
+ */
+static int label_command(const uint8_t *data, uint8_t len, uint8_t target,
+                         int timeout_ms) {
+  for (int i = 0; i < node_count; i++) {
+    nodes[i].has_status = false;
+  }
+  send_frame(data, len);
+
+  uint64_t start = now_ms();
+  is_discovery = true;
+  while (now_ms() - start < (uint64_t)timeout_ms) {
+    receive_answer(10);
+
+    if (target != FW_UPDATE_BROADCAST_ADDR && node_count == 1 &&
+        nodes[0].has_status) {
+      break;
+    }
+  }
+  is_discovery = false;
+
+  int failed = 0;
+  for (int i = 0; i < node_count; i++) {
+    if (!nodes[i].has_status || nodes[i].result != FW_RESULT_OK) {
+      failed++;
+      printf("node %u: label command 0x%02X failed (result %d)\n",
+             nodes[i].addr, data[1],
+             nodes[i].has_status ? nodes[i].result : -1);
+    }
+  }
+  return node_count == 0 ? 1 : failed;
+}
+
+/**
+ * @brief  Загрузка надписей этажей и запись во flash (FW_CMD_LABEL_COMMIT).
+ * @note   Формат: "код=XY,код=X,код=" - 2 символа (MSB, LSB), 1 символ
+ *         (LSB пустой) или пустая надпись (код этажа не отображается).
+ *         Без надписей (spec == NULL) страница надписей стирается.
+ * @param  spec:   Список надписей или NULL.
+ * @param  target: Адрес индикатора или FW_UPDATE_BROADCAST_ADDR.
+ * @retval Код возврата программы.
+ */
+static int upload_labels(const char *spec, uint8_t target) {
+  int failed = 0;
+
+  while (spec != NULL && *spec != '\0' && failed == 0) {
+    char *end = NULL;
+    unsigned long code = strtoul(spec, &end, 0);
+    if (end == spec || *end != '=') {
+      fprintf(stderr, "bad label \"%s\"\n", spec);
+      return EXIT_FAILURE;
+    }
+
+    const char *label = end + 1;
+    size_t label_len = strcspn(label, ",");
+    if (label_len > 2) {
+      fprintf(stderr, "label for code %lu longer than 2 symbols\n", code);
+      return EXIT_FAILURE;
+    }
+
+    uint8_t data[6] = {ISOTP_PCI_SF | 5, FW_CMD_LABEL_SET, target,
+                       (uint8_t)code, 0, 0};
+    if (label_len > 0) {
+      data[4] = (uint8_t)label[0];
+      data[5] = (uint8_t)(label_len == 2 ? label[1] : 'c');
+    }
+    failed = label_command(data, sizeof(data), target, LABEL_TIMEOUT_MS);
+
+    spec = label + label_len + (label[label_len] == ',' ? 1 : 0);
+  }
+
+  if (failed == 0) {
+    uint8_t cmd = (spec == NULL) ? FW_CMD_LABEL_CLEAR : FW_CMD_LABEL_COMMIT;
+    uint8_t data[3] = {ISOTP_PCI_SF | 2, cmd, target};
+    failed = label_command(data, sizeof(data), target, LABEL_COMMIT_TIMEOUT_MS);
+  }
+
+  printf("%d node(s), labels %s\n", node_count,
+         failed == 0 ? "written" : "FAILED");
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief  Чтение одного поля статистики индикатора (FW_CMD_DIAG).
+ * @param  target: Адрес индикатора.
+ * @param  record: Запись fw_diag_record_t.
+ * @param  select: Элемент и поле (элемент << FW_DIAG_ITEM_SHIFT | поле).
+ * @param  value:  Указатель для значения поля.
+ * @retval true, если поле прочитано; false - нет поля или нет ответа.
+ */
+static bool read_diag(uint8_t target, uint8_t record, uint8_t select,
+                      uint32_t *value) {
+  uint8_t data[5] = {ISOTP_PCI_SF | 4, FW_CMD_DIAG, target, record, select};
+
+  for (int i = 0; i < node_count; i++) {
+    nodes[i].has_status = false;
+    nodes[i].has_diag = false;
+  }
+  send_frame(data, sizeof(data));
+
+  uint64_t start = now_ms();
+  is_discovery = true;
+  while (now_ms() - start < DIAG_TIMEOUT_MS) {
+    receive_answer(10);
+
+    node_t *node = find_node(target);
+    if (node != NULL && node->has_diag && node->diag_rec == record &&
+        node->diag_sel == select) {
+      *value = node->diag;
+      is_discovery = false;
+      return true;
+    }
+    if (node != NULL && node->has_status) {
+      break;
+    }
+  }
+  is_discovery = false;
+  return false;
+}
+
+/**
+ * @brief  Чтение статистики индикатора (FW_CMD_DIAG): все поля всех записей.
+ * @note   Поля элемента запрашиваются по одному до ответа FW_RESULT_BAD_DIAG,
+ *         элементы записи - до элемента без полей. Порядок полей - см.
+ *         diagnostics.h.
+ * @param  target: Адрес индикатора.
+ * @retval Код возврата программы.
+ */
+static int query_diagnostics(uint8_t target) {
+  static const char *const records[FW_DIAG_RECORDS_COUNT] = {
+      [FW_DIAG_TASK] = "task",
+      [FW_DIAG_DISPLAY_SYNC] = "display_sync",
+      [FW_DIAG_LINK] = "link",
+      [FW_DIAG_CAN] = "can",
+      [FW_DIAG_PROTOCOL] = "protocol",
+      [FW_DIAG_ISR] = "isr",
+      [FW_DIAG_STARTUP] = "startup",
+  };
+
+  int answered = 0;
+  for (uint8_t record = 0; record < FW_DIAG_RECORDS_COUNT; record++) {
+    for (uint8_t item = 0; item <= FW_DIAG_FIELD_MASK; item++) {
+      uint8_t field = 0;
+      uint32_t value = 0;
+
+      while (field <= FW_DIAG_FIELD_MASK &&
+             read_diag(target, record,
+                       (uint8_t)(item << FW_DIAG_ITEM_SHIFT | field), &value)) {
+        if (field == 0) {
+          printf("%s[%u]:", records[record], item);
+        }
+        printf(" %u", value);
+        field++;
+      }
+
+      if (field == 0) {
+        break;
+      }
+      printf("\n");
+      answered++;
+    }
+  }
+  return answered > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief  Запрос причины последнего перезапуска (FW_CMD_RESET_CAUSE).
+ * @param  target: Адрес индикатора или FW_UPDATE_BROADCAST_ADDR.
+ * @retval Код возврата программы.
+ */
+static int query_reset_cause(uint8_t target) {
+  static const char *const causes[] = {
+      [FW_RESET_UNKNOWN] = "unknown",
+      [FW_RESET_POWER] = "power-on",
+      [FW_RESET_PIN] = "NRST pin",
+      [FW_RESET_SOFTWARE] = "software",
+      [FW_RESET_WATCHDOG] = "watchdog",
+      [FW_RESET_WWDG] = "window watchdog",
+      [FW_RESET_LOW_POWER] = "low-power",
+  };
+
+  send_command(FW_CMD_RESET_CAUSE, target, NULL);
+
+  uint64_t start = now_ms();
+  is_discovery = true;
+  while (now_ms() - start < RESET_INFO_TIMEOUT_MS) {
+    receive_answer(10);
+  }
+  is_discovery = false;
+
+  int answered = 0;
+  for (int i = 0; i < node_count; i++) {
+    if (!nodes[i].has_reset) {
+      continue;
+    }
+    answered++;
+
+    const char *cause = nodes[i].reset < sizeof(causes) / sizeof(causes[0])
+                            ? causes[nodes[i].reset]
+                            : "?";
+    printf("node %u: %s reset, hung tasks 0x%02X, %u watchdog reset(s)\n",
+           nodes[i].addr, cause, nodes[i].hung_mask, nodes[i].wd_resets);
+  }
+  return answered > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+  static uint8_t image[MAX_IMAGE_SIZE];
+
+  if (argc < 3) {
+    fprintf(stderr,
+            "usage: %s <can interface> <image.bin> [address]\n"
+            "       %s <can interface> --labels <code=XY,...> [address]\n"
+            "       %s <can interface> --labels-clear [address]\n"
+            "       %s <can interface> --diag <address>\n"
+            "       %s <can interface> --reset-cause [address]\n",
+            argv[0], argv[0], argv[0], argv[0], argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (strcmp(argv[2], "--reset-cause") == 0) {
+    uint8_t target = (argc > 3) ? (uint8_t)strtoul(argv[3], NULL, 0)
+                                : FW_UPDATE_BROADCAST_ADDR;
+    if (!open_can(argv[1])) {
+      return EXIT_FAILURE;
+    }
+
+    int rc = query_reset_cause(target);
+    close(can_socket);
+    return rc;
+  }
+
+  if (strcmp(argv[2], "--diag") == 0) {
+    uint8_t target = (argc > 3) ? (uint8_t)strtoul(argv[3], NULL, 0)
+                                : FW_UPDATE_BROADCAST_ADDR;
+    if (target == FW_UPDATE_BROADCAST_ADDR) {
+      fprintf(stderr, "--diag: missing address\n");
+      return EXIT_FAILURE;
+    }
+    if (!open_can(argv[1])) {
+      return EXIT_FAILURE;
+    }
+
+    int rc = query_diagnostics(target);
+    close(can_socket);
+    return rc;
+  }
+
+  if (strcmp(argv[2], "--labels") == 0 ||
+      strcmp(argv[2], "--labels-clear") == 0) {
+    bool is_clear = strcmp(argv[2], "--labels-clear") == 0;
+    int addr_arg = is_clear ? 3 : 4;
+    if (!is_clear && argc < 4) {
+      fprintf(stderr, "--labels: missing label list\n");
+      return EXIT_FAILURE;
+    }
+
+    uint8_t target = (argc > addr_arg)
+                         ? (uint8_t)strtoul(argv[addr_arg], NULL, 0)
+                         : FW_UPDATE_BROADCAST_ADDR;
+    if (!open_can(argv[1])) {
+      return EXIT_FAILURE;
+    }
+
+    int rc = upload_labels(is_clear ? NULL : argv[3], target);
+    close(can_socket);
+    return rc;
+  }
+
+  uint8_t target = (argc > 3) ? (uint8_t)strtoul(argv[3], NULL, 0)
+                              : FW_UPDATE_BROADCAST_ADDR;
+  uint32_t size = read_image(argv[2], image);
+  if (size == 0 || !open_can(argv[1])) {
+    return EXIT_FAILURE;
+  }
+  uint32_t crc = fw_update_crc32(0, image, size);
+
+  // Перезапуск индикаторов в загрузчик
+  send_command(FW_CMD_ENTER, target, NULL);
+  usleep(ENTER_DELAY_MS * 1000U);
+
+  int ready = start_nodes(target, size);
+  printf("image %u bytes, crc 0x%08X, %d node(s) ready\n", size, crc, ready);
+  if (ready == 0) {
+    return EXIT_FAILURE;
+  }
+
+  stream_image(image, size);
+  printf("\r%u / %u\n", size, size);
+  commit_nodes(target, crc);
+
+  int failed = 0;
+  for (int i = 0; i < node_count; i++) {
+    bool is_ok = nodes[i].is_active && nodes[i].has_status &&
+                 nodes[i].state == FW_STATE_VERIFIED;
+    failed += is_ok ? 0 : 1;
+    printf("node %u: %s (state %u, result %u)\n", nodes[i].addr,
+           is_ok ? "updated" : "FAILED", nodes[i].state, nodes[i].result);
+  }
+
+  close(can_socket);
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}